@@ -0,0 +1,766 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "chunkedrangelist.h"
+#include "range_p.h"
+
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QVector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+/* Number of identifiers in a chunk */
+static const int C_CHUNK_SIZE = 65536;
+
+/* Number of 64-bit words in a bitmap container */
+static const int C_BITMAP_WORDS = C_CHUNK_SIZE / 64;
+
+/* Cardinality above which an array container is larger than a bitmap container */
+static const int C_MAX_ARRAY_CARDINALITY = 4096;
+
+/***********************************************************************************
+ * CONTAINER HELPERS
+ ***********************************************************************************/
+static QVector<quint64> _q_wordsOf(const ChunkContainer &c)
+{
+    if (c.type == ChunkContainer::BitmapContainer)
+        return c.words;
+
+    QVector<quint64> words(C_BITMAP_WORDS, 0);
+    quint64 *data = words.data();
+    if (c.type == ChunkContainer::ArrayContainer) {
+        foreach (auto value, c.values) {
+            _q_setBit(data, value);
+        }
+    } else {
+        foreach (auto run, c.runs) {
+            _q_setBits(data, run.start, run.last);
+        }
+    }
+    return words;
+}
+
+static QVector<ChunkRun> _q_runsOf(const ChunkContainer &c)
+{
+    if (c.type == ChunkContainer::RunContainer)
+        return c.runs;
+
+    QVector<ChunkRun> runs;
+    if (c.type == ChunkContainer::ArrayContainer) {
+        foreach (auto value, c.values) {
+            if (!runs.isEmpty() && int(runs.last().last) + 1 == value) {
+                runs.last().last = value;
+            } else {
+                ChunkRun run = { value, value };
+                runs.append(run);
+            }
+        }
+    } else {
+        const quint64 *data = c.words.constData();
+        int pos = _q_nextBit(data, C_BITMAP_WORDS, 0, true);
+        while (pos < C_CHUNK_SIZE) {
+            const int end = _q_nextBit(data, C_BITMAP_WORDS, pos, false);
+            ChunkRun run = { quint16(pos), quint16(end - 1) };
+            runs.append(run);
+            pos = (end < C_CHUNK_SIZE) ? _q_nextBit(data, C_BITMAP_WORDS, end, true)
+                                       : C_CHUNK_SIZE;
+        }
+    }
+    return runs;
+}
+
+static QVector<quint16> _q_valuesOf(const ChunkContainer &c)
+{
+    if (c.type == ChunkContainer::ArrayContainer)
+        return c.values;
+
+    QVector<quint16> values;
+    values.reserve(c.cardinality);
+    if (c.type == ChunkContainer::RunContainer) {
+        foreach (auto run, c.runs) {
+            for (int value = run.start; value <= run.last; ++value) {
+                values.append(quint16(value));
+            }
+        }
+    } else {
+        for (int i = 0; i < C_BITMAP_WORDS; ++i) {
+            quint64 w = c.words.at(i);
+            while (w != 0) {
+                values.append(quint16((i << 6) + int(qCountTrailingZeroBits(w))));
+                w &= w - 1;
+            }
+        }
+    }
+    return values;
+}
+
+static inline bool _q_contains(const ChunkContainer &c, const quint16 value)
+{
+    switch (c.type) {
+    case ChunkContainer::ArrayContainer:
+        return std::binary_search(c.values.constBegin(), c.values.constEnd(), value);
+    case ChunkContainer::BitmapContainer:
+        return (c.words.at(value >> 6) >> (value & 63)) & 1;
+    case ChunkContainer::RunContainer: {
+        /* Last run starting before or at value */
+        int lo = 0;
+        int hi = c.runs.count();
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (c.runs.at(mid).start <= value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo > 0 && value <= c.runs.at(lo - 1).last;
+    }
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * \brief Updates the cardinality of the container \a c, and converts it to
+ * its smallest representation.
+ *
+ * Like in Roaring bitmaps, a chunk is stored as runs if they take less than
+ * 4 bytes per run, else as an array up to 4096 identifiers, else as a bitmap.
+ * Since the choice only depends on the identifiers, two equal chunks always
+ * have the same representation.
+ */
+static void _q_optimize(ChunkContainer &c)
+{
+    int runCount = 0;
+    switch (c.type) {
+    case ChunkContainer::ArrayContainer:
+        c.cardinality = c.values.count();
+        for (int i = 0; i < c.cardinality; ++i) {
+            if (i == 0 || int(c.values.at(i - 1)) + 1 != c.values.at(i)) {
+                runCount++;
+            }
+        }
+        break;
+    case ChunkContainer::BitmapContainer: {
+        c.cardinality = 0;
+        quint64 carry = 0;
+        foreach (auto w, c.words) {
+            c.cardinality += int(qPopulationCount(w));
+            runCount += int(qPopulationCount(w & ~((w << 1) | carry)));
+            carry = w >> 63;
+        }
+        break;
+    }
+    case ChunkContainer::RunContainer:
+        c.cardinality = 0;
+        foreach (auto run, c.runs) {
+            c.cardinality += int(run.last) - int(run.start) + 1;
+        }
+        runCount = c.runs.count();
+        break;
+    }
+
+    const int runBytes = 4 * runCount;
+    const int arrayBytes = (c.cardinality <= C_MAX_ARRAY_CARDINALITY)
+            ? 2 * c.cardinality : C_CHUNK_SIZE;
+    const int bitmapBytes = 8 * C_BITMAP_WORDS;
+
+    ChunkContainer::Type type = ChunkContainer::BitmapContainer;
+    if (runBytes <= arrayBytes && runBytes <= bitmapBytes) {
+        type = ChunkContainer::RunContainer;
+    } else if (arrayBytes <= bitmapBytes) {
+        type = ChunkContainer::ArrayContainer;
+    }
+    if (type == c.type)
+        return;
+
+    switch (type) {
+    case ChunkContainer::ArrayContainer: c.values = _q_valuesOf(c); break;
+    case ChunkContainer::BitmapContainer: c.words = _q_wordsOf(c); break;
+    case ChunkContainer::RunContainer: c.runs = _q_runsOf(c); break;
+    }
+    if (type != ChunkContainer::ArrayContainer) c.values.clear();
+    if (type != ChunkContainer::BitmapContainer) c.words.clear();
+    if (type != ChunkContainer::RunContainer) c.runs.clear();
+    c.type = type;
+}
+
+bool ChunkContainer::operator==(const ChunkContainer &other) const
+{
+    return type == other.type
+            && cardinality == other.cardinality
+            && values == other.values
+            && words == other.words
+            && runs == other.runs;
+}
+
+/***********************************************************************************
+ * CONTAINER KERNELS
+ ***********************************************************************************/
+static QVector<ChunkRun> _q_uniteRuns(const QVector<ChunkRun> &runs1,
+                                      const QVector<ChunkRun> &runs2)
+{
+    QVector<ChunkRun> res;
+    res.reserve(runs1.count() + runs2.count());
+    int i = 0;
+    int j = 0;
+    while (i < runs1.count() || j < runs2.count()) {
+        const ChunkRun &run = (j >= runs2.count()
+                               || (i < runs1.count() && runs1.at(i).start <= runs2.at(j).start))
+                ? runs1.at(i++) : runs2.at(j++);
+        if (!res.isEmpty() && int(run.start) <= int(res.last().last) + 1) {
+            res.last().last = qMax(res.last().last, run.last);
+        } else {
+            res.append(run);
+        }
+    }
+    return res;
+}
+
+static QVector<ChunkRun> _q_intersectRuns(const QVector<ChunkRun> &runs1,
+                                          const QVector<ChunkRun> &runs2)
+{
+    QVector<ChunkRun> res;
+    int i = 0;
+    int j = 0;
+    while (i < runs1.count() && j < runs2.count()) {
+        const ChunkRun &r1 = runs1.at(i);
+        const ChunkRun &r2 = runs2.at(j);
+        const quint16 start = qMax(r1.start, r2.start);
+        const quint16 last = qMin(r1.last, r2.last);
+        if (start <= last) {
+            ChunkRun run = { start, last };
+            res.append(run);
+        }
+        if (r1.last < r2.last) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return res;
+}
+
+static QVector<ChunkRun> _q_subtractRuns(const QVector<ChunkRun> &runs,
+                                         const QVector<ChunkRun> &removedRuns)
+{
+    QVector<ChunkRun> res;
+    int j = 0;
+    foreach (auto run, runs) {
+        int pos = run.start;
+        while (j < removedRuns.count() && removedRuns.at(j).last < pos) {
+            j++;
+        }
+        int k = j;
+        while (k < removedRuns.count() && removedRuns.at(k).start <= run.last) {
+            const ChunkRun &removed = removedRuns.at(k);
+            if (pos < removed.start) {
+                ChunkRun piece = { quint16(pos), quint16(removed.start - 1) };
+                res.append(piece);
+            }
+            pos = removed.last + 1;
+            if (removed.last >= run.last)
+                break;
+            k++;
+        }
+        if (pos <= run.last) {
+            ChunkRun piece = { quint16(pos), run.last };
+            res.append(piece);
+        }
+        j = k;
+    }
+    return res;
+}
+
+static QVector<quint16> _q_filter(const QVector<quint16> &values,
+                                  const ChunkContainer &c, const bool isKept)
+{
+    QVector<quint16> res;
+    res.reserve(values.count());
+    foreach (auto value, values) {
+        if (_q_contains(c, value) == isKept) {
+            res.append(value);
+        }
+    }
+    return res;
+}
+
+static ChunkContainer _q_uniteChunks(const ChunkContainer &a, const ChunkContainer &b)
+{
+    ChunkContainer res;
+    if (a.type == ChunkContainer::ArrayContainer && b.type == ChunkContainer::ArrayContainer) {
+        res.type = ChunkContainer::ArrayContainer;
+        res.values.reserve(a.values.count() + b.values.count());
+        std::set_union(a.values.constBegin(), a.values.constEnd(),
+                       b.values.constBegin(), b.values.constEnd(),
+                       std::back_inserter(res.values));
+
+    } else if (a.type == ChunkContainer::RunContainer && b.type == ChunkContainer::RunContainer) {
+        res.type = ChunkContainer::RunContainer;
+        res.runs = _q_uniteRuns(a.runs, b.runs);
+
+    } else {
+        const ChunkContainer &base = (b.type == ChunkContainer::BitmapContainer) ? b : a;
+        const ChunkContainer &added = (&base == &a) ? b : a;
+        res.type = ChunkContainer::BitmapContainer;
+        res.words = _q_wordsOf(base);
+        quint64 *data = res.words.data();
+        if (added.type == ChunkContainer::ArrayContainer) {
+            foreach (auto value, added.values) {
+                _q_setBit(data, value);
+            }
+        } else if (added.type == ChunkContainer::RunContainer) {
+            foreach (auto run, added.runs) {
+                _q_setBits(data, run.start, run.last);
+            }
+        } else {
+            const quint64 *other = added.words.constData();
+            for (int i = 0; i < C_BITMAP_WORDS; ++i) {
+                data[i] |= other[i];
+            }
+        }
+    }
+    _q_optimize(res);
+    return res;
+}
+
+static ChunkContainer _q_intersectChunks(const ChunkContainer &a, const ChunkContainer &b)
+{
+    ChunkContainer res;
+    if (a.type == ChunkContainer::ArrayContainer && b.type == ChunkContainer::ArrayContainer) {
+        res.type = ChunkContainer::ArrayContainer;
+        std::set_intersection(a.values.constBegin(), a.values.constEnd(),
+                              b.values.constBegin(), b.values.constEnd(),
+                              std::back_inserter(res.values));
+
+    } else if (a.type == ChunkContainer::ArrayContainer) {
+        res.type = ChunkContainer::ArrayContainer;
+        res.values = _q_filter(a.values, b, true);
+
+    } else if (b.type == ChunkContainer::ArrayContainer) {
+        res.type = ChunkContainer::ArrayContainer;
+        res.values = _q_filter(b.values, a, true);
+
+    } else if (a.type == ChunkContainer::RunContainer && b.type == ChunkContainer::RunContainer) {
+        res.type = ChunkContainer::RunContainer;
+        res.runs = _q_intersectRuns(a.runs, b.runs);
+
+    } else {
+        res.type = ChunkContainer::BitmapContainer;
+        res.words = _q_wordsOf(a);
+        const QVector<quint64> other = _q_wordsOf(b);
+        quint64 *data = res.words.data();
+        const quint64 *mask = other.constData();
+        for (int i = 0; i < C_BITMAP_WORDS; ++i) {
+            data[i] &= mask[i];
+        }
+    }
+    _q_optimize(res);
+    return res;
+}
+
+static ChunkContainer _q_subtractChunks(const ChunkContainer &a, const ChunkContainer &b)
+{
+    ChunkContainer res;
+    if (a.type == ChunkContainer::ArrayContainer && b.type == ChunkContainer::ArrayContainer) {
+        res.type = ChunkContainer::ArrayContainer;
+        std::set_difference(a.values.constBegin(), a.values.constEnd(),
+                            b.values.constBegin(), b.values.constEnd(),
+                            std::back_inserter(res.values));
+
+    } else if (a.type == ChunkContainer::ArrayContainer) {
+        res.type = ChunkContainer::ArrayContainer;
+        res.values = _q_filter(a.values, b, false);
+
+    } else if (a.type == ChunkContainer::RunContainer && b.type == ChunkContainer::RunContainer) {
+        res.type = ChunkContainer::RunContainer;
+        res.runs = _q_subtractRuns(a.runs, b.runs);
+
+    } else {
+        res.type = ChunkContainer::BitmapContainer;
+        res.words = _q_wordsOf(a);
+        quint64 *data = res.words.data();
+        if (b.type == ChunkContainer::ArrayContainer) {
+            foreach (auto value, b.values) {
+                _q_clearBit(data, value);
+            }
+        } else {
+            const QVector<quint64> other = _q_wordsOf(b);
+            const quint64 *mask = other.constData();
+            for (int i = 0; i < C_BITMAP_WORDS; ++i) {
+                data[i] &= ~mask[i];
+            }
+        }
+    }
+    _q_optimize(res);
+    return res;
+}
+
+/*!
+ * \internal
+ * \brief Returns the container of the chunk of \a identifier, appended after
+ * the containers already filled, which are converted to their smallest
+ * representation.
+ */
+template <typename T>
+static inline ChunkContainer &_q_lastChunk(QVector<T> &keys, QVector<ChunkContainer> &containers,
+                                           const qint64 identifier)
+{
+    const T key = T(identifier >> 16);
+    if (keys.isEmpty() || keys.last() != key) {
+        if (!containers.isEmpty()) {
+            _q_optimize(containers.last());
+        }
+        keys.append(key);
+        ChunkContainer c;
+        c.type = ChunkContainer::RunContainer;
+        containers.append(c);
+    }
+    return containers.last();
+}
+
+/*!
+ * \internal
+ * \brief Appends the identifiers from \a first to \a last, both in the same
+ * chunk and greater than the identifiers already appended.
+ */
+template <typename T>
+static inline void _q_appendRun(QVector<T> &keys, QVector<ChunkContainer> &containers,
+                                const qint64 first, const qint64 last)
+{
+    ChunkContainer &c = _q_lastChunk(keys, containers, first);
+    const quint16 start = quint16(first & 0xFFFF);
+    if (c.type == ChunkContainer::BitmapContainer) {
+        _q_setBits(c.words.data(), start, int(last & 0xFFFF));
+        return;
+    }
+    QVector<ChunkRun> &runs = c.runs;
+    if (!runs.isEmpty() && int(runs.last().last) + 1 == start) {
+        runs.last().last = quint16(last & 0xFFFF);
+    } else {
+        ChunkRun run = { start, quint16(last & 0xFFFF) };
+        runs.append(run);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Appends every \a by identifiers from \a first to \a last, like
+ * _q_appendRun().
+ *
+ * A few identifiers are appended as runs. Otherwise the container becomes
+ * a bitmap, and the identifiers are set word by word.
+ */
+template <typename T>
+static inline void _q_appendStrided(QVector<T> &keys, QVector<ChunkContainer> &containers,
+                                    const qint64 first, const qint64 last, const qint64 by)
+{
+    ChunkContainer &c = _q_lastChunk(keys, containers, first);
+    const int start = int(first & 0xFFFF);
+    const int end = int(last & 0xFFFF);
+    const int count = int((end - start) / by) + 1;
+    /* Runs are smaller than a bitmap up to 2048 runs */
+    if (c.type == ChunkContainer::RunContainer
+            && c.runs.count() + count <= C_MAX_ARRAY_CARDINALITY / 2) {
+        for (int value = start; value <= end; value += int(by)) {
+            if (!c.runs.isEmpty() && int(c.runs.last().last) + 1 == value) {
+                c.runs.last().last = quint16(value);
+            } else {
+                ChunkRun run = { quint16(value), quint16(value) };
+                c.runs.append(run);
+            }
+        }
+        return;
+    }
+    if (c.type == ChunkContainer::RunContainer) {
+        c.words = _q_wordsOf(c);
+        c.runs.clear();
+        c.type = ChunkContainer::BitmapContainer;
+    }
+    _q_setBitsStrided(c.words.data(), start, end, int(by));
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \class BasicChunkedRangeList
+ *
+ * The identifier space is split in chunks of 65536 identifiers, and each chunk
+ * is stored in the smallest of three containers: a list of runs, a sorted
+ * array of 16-bit values, or a bitmap. Hence, isolated identifiers cost 2 bytes
+ * instead of a whole Range, and dense chunks cost at most 8 KB.
+ *
+ * Set operations are done chunk by chunk. Two bitmaps are combined word by word,
+ * in loops that the compiler can vectorize.
+ *
+ * \code
+ *   ChunkedRangeList set1( *Parser::instance()->parse(text1) );
+ *   ChunkedRangeList set2( *Parser::instance()->parse(text2) );
+ *   set1.intersect(set2);
+ *   RangeList result = set1.toRangeList();
+ * \endcode
+ */
+template <typename T>
+BasicChunkedRangeList<T>::BasicChunkedRangeList()
+{
+}
+
+/*!
+ * \brief Creates a chunked list with the identifiers of the \a rangeList.
+ *
+ * The ranges are split at the chunk bounds, and each piece is filled at once:
+ * continuous pieces as runs, and strided pieces with a stride in a bitmap.
+ * Hence, the cost depends on the number of chunks, not on the number of identifiers.
+ */
+template <typename T>
+BasicChunkedRangeList<T>::BasicChunkedRangeList(const BasicRangeList<T> &rangeList)
+{
+    for (const BasicRange<T> &range : rangeList.view()) {
+        const qint64 to = range.to();
+        const qint64 by = range.by();
+        for (qint64 first = range.from(); first <= to; ) {
+            const qint64 chunkLast = qMin(to, first | 0xFFFF);
+            const qint64 last = first + ((chunkLast - first) / by) * by;
+            if (by == 1 || first == last) {
+                _q_appendRun(m_keys, m_containers, first, last);
+            } else {
+                _q_appendStrided(m_keys, m_containers, first, last, by);
+            }
+            first = last + by;
+        }
+    }
+    if (!m_containers.isEmpty()) {
+        _q_optimize(m_containers.last());
+    }
+}
+
+template <typename T>
+void BasicChunkedRangeList<T>::clear()
+{
+    m_keys.clear();
+    m_containers.clear();
+}
+
+template <typename T>
+bool BasicChunkedRangeList<T>::isEmpty() const
+{
+    return m_keys.isEmpty();
+}
+
+/*!
+ * \brief Returns the number of unique identifiers.
+ */
+template <typename T>
+T BasicChunkedRangeList<T>::count() const
+{
+    T count = 0;
+    foreach (auto c, m_containers) {
+        count += c.cardinality;
+    }
+    return count;
+}
+
+/*!
+ * \brief [FOR UNIT TEST ONLY] Returns the number of the chunks.
+ */
+template <typename T>
+int BasicChunkedRangeList<T>::countChunks() const
+{
+    return m_keys.count();
+}
+
+/*!
+ * \brief Returns the approximate number of bytes used by the identifiers.
+ */
+template <typename T>
+qint64 BasicChunkedRangeList<T>::memoryUsage() const
+{
+    qint64 bytes = sizeof(*this) + m_keys.count() * qint64(sizeof(T));
+    foreach (auto c, m_containers) {
+        bytes += sizeof(ChunkContainer)
+                + c.values.count() * qint64(sizeof(quint16))
+                + c.words.count() * qint64(sizeof(quint64))
+                + c.runs.count() * qint64(sizeof(ChunkRun));
+    }
+    return bytes;
+}
+
+/*!
+ * \brief Returns true if the list contains the given \a identifier.
+ */
+template <typename T>
+bool BasicChunkedRangeList<T>::contains(const T identifier) const
+{
+    if (identifier <= 0)
+        return false;
+    const typename QVector<T>::const_iterator it =
+            std::lower_bound(m_keys.constBegin(), m_keys.constEnd(), T(identifier >> 16));
+    if (it == m_keys.constEnd() || *it != T(identifier >> 16))
+        return false;
+    return _q_contains(m_containers.at(int(it - m_keys.constBegin())),
+                       quint16(identifier & 0xFFFF));
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Adds the identifiers of the \a other list.
+ */
+template <typename T>
+void BasicChunkedRangeList<T>::unite(const BasicChunkedRangeList<T> &other)
+{
+    QVector<T> keys;
+    QVector<ChunkContainer> containers;
+    keys.reserve(m_keys.count() + other.m_keys.count());
+    containers.reserve(m_keys.count() + other.m_keys.count());
+
+    int i = 0;
+    int j = 0;
+    while (i < m_keys.count() || j < other.m_keys.count()) {
+        if (j >= other.m_keys.count()
+                || (i < m_keys.count() && m_keys.at(i) < other.m_keys.at(j))) {
+            keys.append(m_keys.at(i));
+            containers.append(m_containers.at(i++));
+        } else if (i >= m_keys.count() || other.m_keys.at(j) < m_keys.at(i)) {
+            keys.append(other.m_keys.at(j));
+            containers.append(other.m_containers.at(j++));
+        } else {
+            keys.append(m_keys.at(i));
+            containers.append(_q_uniteChunks(m_containers.at(i++), other.m_containers.at(j++)));
+        }
+    }
+    m_keys = keys;
+    m_containers = containers;
+}
+
+/*!
+ * \brief Keeps only the identifiers that are also in the \a other list.
+ */
+template <typename T>
+void BasicChunkedRangeList<T>::intersect(const BasicChunkedRangeList<T> &other)
+{
+    QVector<T> keys;
+    QVector<ChunkContainer> containers;
+
+    int i = 0;
+    int j = 0;
+    while (i < m_keys.count() && j < other.m_keys.count()) {
+        if (m_keys.at(i) < other.m_keys.at(j)) {
+            i++;
+        } else if (other.m_keys.at(j) < m_keys.at(i)) {
+            j++;
+        } else {
+            const ChunkContainer c = _q_intersectChunks(m_containers.at(i), other.m_containers.at(j));
+            if (c.cardinality > 0) {
+                keys.append(m_keys.at(i));
+                containers.append(c);
+            }
+            i++;
+            j++;
+        }
+    }
+    m_keys = keys;
+    m_containers = containers;
+}
+
+/*!
+ * \brief Removes the identifiers of the \a other list.
+ */
+template <typename T>
+void BasicChunkedRangeList<T>::subtract(const BasicChunkedRangeList<T> &other)
+{
+    QVector<T> keys;
+    QVector<ChunkContainer> containers;
+    keys.reserve(m_keys.count());
+    containers.reserve(m_keys.count());
+
+    int j = 0;
+    for (int i = 0; i < m_keys.count(); ++i) {
+        while (j < other.m_keys.count() && other.m_keys.at(j) < m_keys.at(i)) {
+            j++;
+        }
+        if (j < other.m_keys.count() && other.m_keys.at(j) == m_keys.at(i)) {
+            const ChunkContainer c = _q_subtractChunks(m_containers.at(i), other.m_containers.at(j));
+            if (c.cardinality > 0) {
+                keys.append(m_keys.at(i));
+                containers.append(c);
+            }
+        } else {
+            keys.append(m_keys.at(i));
+            containers.append(m_containers.at(i));
+        }
+    }
+    m_keys = keys;
+    m_containers = containers;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Returns the identifiers as canonical ranges.
+ */
+template <typename T>
+BasicRangeList<T> BasicChunkedRangeList<T>::toRangeList() const
+{
+    BasicRangeArray<T> ranges;
+    RangePacker<T> packer(&ranges);
+    for (int i = 0; i < m_keys.count(); ++i) {
+        const qint64 base = qint64(m_keys.at(i)) << 16;
+        const ChunkContainer &c = m_containers.at(i);
+        if (c.type == ChunkContainer::ArrayContainer) {
+            foreach (auto value, c.values) {
+                packer.push(base + value);
+            }
+        } else {
+            foreach (auto run, _q_runsOf(c)) {
+                packer.push(base + run.start, base + run.last, 1);
+            }
+        }
+    }
+    packer.finish();
+
+    BasicRangeList<T> res;
+    res.setCanonicalRanges(std::move(ranges));
+    return res;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+bool BasicChunkedRangeList<T>::operator==(const BasicChunkedRangeList<T> &other) const
+{
+    return m_keys == other.m_keys && m_containers == other.m_containers;
+}
+
+template <typename T>
+bool BasicChunkedRangeList<T>::operator!=(const BasicChunkedRangeList<T> &other) const
+{
+    return ((*this) == other) ? false : true;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template class BasicChunkedRangeList<Identifier>;
+template class BasicChunkedRangeList<Identifier64>;
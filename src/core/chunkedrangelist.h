@@ -0,0 +1,121 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHUNKEDRANGELIST_H
+#define CHUNKEDRANGELIST_H
+
+#include "rangelist.h"
+
+#include <QtCore/QVector>
+
+/*!
+ * \internal
+ * \brief Run of consecutive identifiers in a chunk, bounds included.
+ */
+struct ChunkRun
+{
+    quint16 start;
+    quint16 last;
+
+    inline bool operator==(const ChunkRun &other) const
+    { return start == other.start && last == other.last; }
+};
+
+Q_DECLARE_TYPEINFO(ChunkRun, Q_PRIMITIVE_TYPE);
+
+/*!
+ * \internal
+ * \brief Identifiers of a chunk, i.e. the 16 low bits of the identifiers
+ * that share the same 16 high bits.
+ *
+ * Only one of the representations is used, the smallest for this chunk:
+ * \list
+ * \li ArrayContainer: sorted values, 2 bytes per identifier (up to 4096 identifiers).
+ * \li BitmapContainer: 1024 words of 64 bits, 8 KB whatever the identifiers.
+ * \li RunContainer: runs of consecutive identifiers, 4 bytes per run.
+ * \endlist
+ */
+struct ChunkContainer
+{
+    enum Type {
+        ArrayContainer,
+        BitmapContainer,
+        RunContainer
+    };
+
+    ChunkContainer() : type(ArrayContainer), cardinality(0) {}
+
+    Type type;
+    int cardinality;
+    QVector<quint16> values;
+    QVector<quint64> words;
+    QVector<ChunkRun> runs;
+
+    bool operator==(const ChunkContainer &other) const;
+};
+
+Q_DECLARE_TYPEINFO(ChunkContainer, Q_MOVABLE_TYPE);
+
+/*!
+ * \class BasicChunkedRangeList
+ * \brief The BasicChunkedRangeList class is a set of identifiers of type \a T,
+ * partitioned into chunks of 65536 identifiers.
+ *
+ * Use ChunkedRangeList for 32-bit identifiers, and ChunkedRangeList64 for
+ * 64-bit identifiers.
+ */
+template <typename T>
+class BasicChunkedRangeList
+{
+public:
+    explicit BasicChunkedRangeList();
+    explicit BasicChunkedRangeList(const BasicRangeList<T> &rangeList);
+
+    void clear();
+    bool isEmpty() const;
+    T count() const;
+    int countChunks() const;
+    qint64 memoryUsage() const;
+
+    bool contains(const T identifier) const;
+
+    void unite(const BasicChunkedRangeList<T> &other);
+    void intersect(const BasicChunkedRangeList<T> &other);
+    void subtract(const BasicChunkedRangeList<T> &other);
+
+    BasicRangeList<T> toRangeList() const;
+
+    bool operator==(const BasicChunkedRangeList<T> &other) const;
+    bool operator!=(const BasicChunkedRangeList<T> &other) const;
+
+private:
+    QVector<T> m_keys; ///< Sorted high bits of the chunks.
+    QVector<ChunkContainer> m_containers; ///< Low bits of the chunks, never empty.
+
+};
+
+typedef BasicChunkedRangeList<Identifier> ChunkedRangeList;
+typedef BasicChunkedRangeList<Identifier64> ChunkedRangeList64;
+
+#endif // CHUNKEDRANGELIST_H
@@ -1,18 +1,28 @@
 HEADERS  += \
+    $$PWD/chunkedrangelist.h \
+    $$PWD/decimal_p.h \
     $$PWD/exporter.h \
+    $$PWD/externalsorter.h \
     $$PWD/parser.h \
     $$PWD/range.h \
+    $$PWD/range_p.h \
+    $$PWD/rangeblock.h \
     $$PWD/rangehelper.h \
     $$PWD/rangelist.h \
+    $$PWD/rangelistbuilder.h \
     $$PWD/rangelistmodel.h \
     $$PWD/rangelistmodel_p.h
 
 SOURCES += \
+    $$PWD/chunkedrangelist.cpp \
     $$PWD/exporter.cpp \
+    $$PWD/externalsorter.cpp \
     $$PWD/parser.cpp \
     $$PWD/range.cpp \
+    $$PWD/rangeblock.cpp \
     $$PWD/rangehelper.cpp \
     $$PWD/rangelist.cpp \
+    $$PWD/rangelistbuilder.cpp \
     $$PWD/rangelistmodel.cpp
 
-
+include($$PWD/simd.pri)
@@ -0,0 +1,278 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DECIMAL_P_H
+#define DECIMAL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public API. It contains the kernels converting
+// runs of decimal digits to integers, for the Parser and the file importers.
+//
+
+#include <QtCore/QtGlobal>
+#include <QtCore/QtAlgorithms>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+static const int C_MAX_DIGITS_PER_STEP = 16;
+
+static const quint64 C_POWERS_OF_10[C_MAX_DIGITS_PER_STEP + 1] = {
+    Q_UINT64_C(1),
+    Q_UINT64_C(10),
+    Q_UINT64_C(100),
+    Q_UINT64_C(1000),
+    Q_UINT64_C(10000),
+    Q_UINT64_C(100000),
+    Q_UINT64_C(1000000),
+    Q_UINT64_C(10000000),
+    Q_UINT64_C(100000000),
+    Q_UINT64_C(1000000000),
+    Q_UINT64_C(10000000000),
+    Q_UINT64_C(100000000000),
+    Q_UINT64_C(1000000000000),
+    Q_UINT64_C(10000000000000),
+    Q_UINT64_C(100000000000000),
+    Q_UINT64_C(1000000000000000),
+    Q_UINT64_C(10000000000000000)
+};
+
+static inline bool _q_isDigit(const ushort c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/*!
+ * \internal
+ * \brief Returns the number of ASCII digits at the beginning of the \a count
+ * characters of \a text, checked one by one.
+ *
+ * This is the reference of the vector kernels of _q_digitCount().
+ */
+template <typename Char>
+static inline int _q_digitCountScalar(const Char *text, const int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (!_q_isDigit(ushort(text[i])))
+            return i;
+    }
+    return count;
+}
+
+/*!
+ * \internal
+ * \brief Returns the value of the \a count ASCII digits of \a text,
+ * converted one by one.
+ *
+ * This is the reference of the vector kernels of _q_digitsValue().
+ */
+template <typename Char>
+static inline quint64 _q_digitsValueScalar(const Char *text, const int count)
+{
+    quint64 value = 0;
+    for (int i = 0; i < count; ++i) {
+        value = value * 10 + quint64(text[i] - '0');
+    }
+    return value;
+}
+
+/*!
+ * \internal
+ * \brief Returns the number of ASCII digits at the beginning of the \a count
+ * characters of \a text. The \a count must not exceed C_MAX_DIGITS_PER_STEP.
+ *
+ * The characters are checked by blocks of 16 or 8 with AVX2 or SSE2,
+ * when the compiler targets them (AVX2 needs CONFIG+=simd, see simd.pri),
+ * and one by one otherwise.
+ */
+static inline int _q_digitCount(const ushort *text, const int count)
+{
+    Q_ASSERT(count <= C_MAX_DIGITS_PER_STEP);
+    int i = 0;
+#if defined(__AVX2__)
+    if (count == 16) {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text));
+        const __m256i offsets = _mm256_subs_epu16(_mm256_sub_epi16(chars, _mm256_set1_epi16('0')),
+                                                  _mm256_set1_epi16(9));
+        const uint mask = uint(_mm256_movemask_epi8(
+                                   _mm256_cmpeq_epi16(offsets, _mm256_setzero_si256())));
+        return mask == 0xFFFFFFFFu ? 16 : int(qCountTrailingZeroBits(~mask)) / 2;
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+        const __m128i offsets = _mm_subs_epu16(_mm_sub_epi16(chars, _mm_set1_epi16('0')),
+                                               _mm_set1_epi16(9));
+        const uint mask = uint(_mm_movemask_epi8(_mm_cmpeq_epi16(offsets, _mm_setzero_si128())));
+        if (mask != 0xFFFF)
+            return i + int(qCountTrailingZeroBits(~mask & 0xFFFF)) / 2;
+    }
+#endif
+    return i + _q_digitCountScalar(text + i, count - i);
+}
+
+/*!
+ * \internal
+ * \overload
+ * The 8-bit characters are checked by blocks of 16 with SSE2.
+ */
+static inline int _q_digitCount(const char *text, const int count)
+{
+    Q_ASSERT(count <= C_MAX_DIGITS_PER_STEP);
+    int i = 0;
+#if defined(__SSE2__)
+    if (count == 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+        const __m128i offsets = _mm_subs_epu8(_mm_sub_epi8(chars, _mm_set1_epi8('0')),
+                                              _mm_set1_epi8(9));
+        const uint mask = uint(_mm_movemask_epi8(_mm_cmpeq_epi8(offsets, _mm_setzero_si128())));
+        return mask == 0xFFFF ? 16 : int(qCountTrailingZeroBits(~mask & 0xFFFF));
+    }
+#endif
+    return i + _q_digitCountScalar(reinterpret_cast<const uchar *>(text) + i, count - i);
+}
+
+#if defined(__SSE4_1__)
+/*!
+ * \internal
+ * \brief Returns the value of the \a count first ASCII digits of \a chars,
+ * a vector of 16 characters.
+ *
+ * The digits are right-aligned with a shuffle, then multiplied and added
+ * pairwise: 16 digits give 8 values of 2 digits, 4 values of 4 digits,
+ * and at last 2 values of 8 digits.
+ */
+static inline quint64 _q_digitsValue(const __m128i chars, const int count)
+{
+    /* Loaded at offset count, selects the count first bytes to the end of the vector */
+    static const qint8 C_RIGHT_ALIGN[32] = {
+        -128, -128, -128, -128, -128, -128, -128, -128,
+        -128, -128, -128, -128, -128, -128, -128, -128,
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+    };
+    __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    digits = _mm_shuffle_epi8(digits, _mm_loadu_si128(
+                                  reinterpret_cast<const __m128i *>(C_RIGHT_ALIGN + count)));
+    digits = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                     10, 1, 10, 1, 10, 1, 10, 1));
+    digits = _mm_madd_epi16(digits, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    digits = _mm_packus_epi32(digits, digits);
+    digits = _mm_madd_epi16(digits, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    const quint64 high = quint32(_mm_cvtsi128_si32(digits));
+    const quint64 low = quint32(_mm_extract_epi32(digits, 1));
+    return high * Q_UINT64_C(100000000) + low;
+}
+#endif
+
+/*!
+ * \internal
+ * \brief Returns the value of the \a count ASCII digits of \a text.
+ * The \a count must not exceed C_MAX_DIGITS_PER_STEP.
+ *
+ * \a available is the number of characters that can be read from \a text,
+ * including the digits. With SSE4.1, i.e. when built with CONFIG+=simd,
+ * the digits are converted at once, if the characters that fill the vectors
+ * can be read. Otherwise, they're converted one by one.
+ */
+static inline quint64 _q_digitsValue(const ushort *text, const int count, const int available)
+{
+    Q_ASSERT(count <= C_MAX_DIGITS_PER_STEP && count <= available);
+#if defined(__SSE4_1__)
+    if (available >= 16) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 8));
+        return _q_digitsValue(_mm_packus_epi16(first, second), count);
+    }
+    if (available >= 8 && count <= 8) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+        return _q_digitsValue(_mm_packus_epi16(first, _mm_setzero_si128()), count);
+    }
+#else
+    Q_UNUSED(available);
+#endif
+    return _q_digitsValueScalar(text, count);
+}
+
+/*!
+ * \internal
+ * \overload
+ */
+static inline quint64 _q_digitsValue(const char *text, const int count, const int available)
+{
+    Q_ASSERT(count <= C_MAX_DIGITS_PER_STEP && count <= available);
+#if defined(__SSE4_1__)
+    if (available >= 16)
+        return _q_digitsValue(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text)), count);
+#else
+    Q_UNUSED(available);
+#endif
+    return _q_digitsValueScalar(text, count);
+}
+
+/*!
+ * \internal
+ * \brief Reads the run of ASCII digits starting at \a it, and appends it
+ * to the decimal \a value. Returns the position after the last digit.
+ *
+ * Like QString::toLongLong(), a value greater than \a limit overflows:
+ * then \a overflow is set, and the digits are skipped.
+ *
+ * Example:
+ *    value = 12, text = "345:678" -> value = 12345, returns the position of ':'
+ */
+template <typename Char>
+static inline const Char *_q_readDigits(const Char *it, const Char *end,
+                                        quint64 &value, bool &overflow,
+                                        const quint64 limit)
+{
+    for (;;) {
+        const int available = int(qMin<qptrdiff>(end - it, 1 << 30));
+        const int count = _q_digitCount(it, qMin(available, C_MAX_DIGITS_PER_STEP));
+        if (count == 0)
+            return it;
+
+        if (!overflow) {
+            const quint64 digits = _q_digitsValue(it, count, available);
+            /* No division for the first run of digits, usually the only one */
+            if (digits > limit
+                    || (value != 0 && value > (limit - digits) / C_POWERS_OF_10[count])) {
+                overflow = true;
+            } else {
+                value = value * C_POWERS_OF_10[count] + digits;
+            }
+        }
+        it += count;
+        if (count < C_MAX_DIGITS_PER_STEP)
+            return it;
+    }
+}
+
+#endif // DECIMAL_P_H
@@ -0,0 +1,493 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "externalsorter.h"
+#include "range_p.h"
+
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QVector>
+#include <algorithm>
+#include <utility>
+
+/* Default peak memory of the buffers, in bytes */
+static const qint64 C_DEFAULT_MEMORY_LIMIT = Q_INT64_C(256) << 20;
+
+/* Minimum number of identifiers read or written at once in a run */
+static const int C_MIN_BLOCK_SIZE = 4096;
+
+/*!
+ * \internal
+ * \brief Sorted run being read by the merge, one block at a time.
+ */
+template <typename T>
+struct RunReader
+{
+    QTemporaryFile *file;
+    QVector<T> block;
+    int position;
+    int size;
+    bool failed;
+
+    /* Reads the next block. Returns false at the end of the run, or on error.
+     * A run truncated in the middle of an identifier can't be read either. */
+    bool fill()
+    {
+        const qint64 bytes = file->read(reinterpret_cast<char*>(block.data()),
+                                        qint64(block.count()) * qint64(sizeof(T)));
+        failed = bytes < 0 || bytes % qint64(sizeof(T)) != 0;
+        position = 0;
+        size = failed ? 0 : int(bytes / qint64(sizeof(T)));
+        return size > 0;
+    }
+};
+
+/*!
+ * \internal
+ * \brief Current value of a run in the heap of the merge.
+ */
+template <typename T>
+struct RunHead
+{
+    T value;
+    int run;
+};
+
+template <typename T>
+static inline bool _q_headGreaterThan(const RunHead<T> &h1, const RunHead<T> &h2)
+{
+    return h1.value > h2.value;
+}
+
+/* The values are flushed, so that a full disk is reported by the write */
+template <typename T>
+static inline bool _q_write(QTemporaryFile *file, const T *values, const int count)
+{
+    const qint64 bytes = qint64(count) * qint64(sizeof(T));
+    return file->write(reinterpret_cast<const char*>(values), bytes) == bytes
+            && file->flush();
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+BasicExternalSorter<T>::BasicExternalSorter(const qint64 memoryLimit)
+    : m_memoryLimit(memoryLimit)
+    , m_count(0)
+{
+    m_buffer.reserve(bufferCapacity());
+}
+
+template <typename T>
+BasicExternalSorter<T>::~BasicExternalSorter()
+{
+    qDeleteAll(m_runs);
+}
+
+/*!
+ * \brief Returns the default memory limit, 256 MB.
+ */
+template <typename T>
+qint64 BasicExternalSorter<T>::defaultMemoryLimit()
+{
+    return C_DEFAULT_MEMORY_LIMIT;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+qint64 BasicExternalSorter<T>::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+/*!
+ * \brief Sets the peak memory, in \a bytes, of the buffers used to sort
+ * and to merge the identifiers.
+ *
+ * The limit is not exact: the buffers hold at least a few thousands identifiers.
+ * Changing the limit doesn't affect the runs already spilled.
+ */
+template <typename T>
+void BasicExternalSorter<T>::setMemoryLimit(const qint64 bytes)
+{
+    m_memoryLimit = bytes;
+    if (m_buffer.isEmpty())
+        m_buffer.squeeze();
+    m_buffer.reserve(bufferCapacity());
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Removes all the identifiers, the temporary files and the error.
+ */
+template <typename T>
+void BasicExternalSorter<T>::clear()
+{
+    qDeleteAll(m_runs);
+    m_runs.clear();
+    m_buffer.clear();
+    m_buffer.squeeze();
+    m_buffer.reserve(bufferCapacity());
+    m_count = 0;
+    m_errorString.clear();
+}
+
+/*!
+ * \brief Returns the number of identifiers added, duplicates included.
+ */
+template <typename T>
+qint64 BasicExternalSorter<T>::count() const
+{
+    return m_count;
+}
+
+/*!
+ * \brief Returns the number of runs spilled to temporary files.
+ */
+template <typename T>
+int BasicExternalSorter<T>::countRuns() const
+{
+    return m_runs.count();
+}
+
+/*!
+ * \brief [FOR UNIT TEST ONLY] Returns the file names of the runs spilled to disk.
+ */
+template <typename T>
+QStringList BasicExternalSorter<T>::runFileNames() const
+{
+    QStringList res;
+    foreach (auto run, m_runs) {
+        res << run->fileName();
+    }
+    return res;
+}
+
+/*!
+ * \brief [FOR UNIT TEST ONLY] Returns the memory, in bytes, allocated by the buffer.
+ */
+template <typename T>
+qint64 BasicExternalSorter<T>::bufferSize() const
+{
+    return qint64(m_buffer.capacity()) * qint64(sizeof(T));
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Adds the given \a identifier.
+ * Returns false if the buffer can't be spilled to disk.
+ *
+ * Identifiers that can't be held by a range are ignored.
+ */
+template <typename T>
+bool BasicExternalSorter<T>::add(const T identifier)
+{
+    if (identifier <= 0 || identifier > BasicRange<T>::maximum())
+        return !hasError();
+    m_buffer.append(identifier);
+    m_count++;
+    if (m_buffer.count() >= bufferCapacity())
+        return spill();
+    return !hasError();
+}
+
+template <typename T>
+bool BasicExternalSorter<T>::add(const QVector<T> &identifiers)
+{
+    foreach (auto identifier, identifiers) {
+        if (!add(identifier))
+            return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Adds the identifiers of the given \a range.
+ * The range is expanded, use BasicRangeList::add() for ranges that fit in memory.
+ */
+template <typename T>
+bool BasicExternalSorter<T>::add(const BasicRange<T> &range)
+{
+    if (range.isEmpty())
+        return !hasError();
+    const qint64 to = range.to();
+    const qint64 by = range.by();
+    for (qint64 identifier = range.from(); identifier <= to; identifier += by) {
+        if (!add(T(identifier)))
+            return false;
+    }
+    return true;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Collapses all the identifiers into the canonical ranges of \a result.
+ * Returns false if a run can't be read or written.
+ *
+ * The identifiers are removed from the sorter, but the error string is kept.
+ */
+template <typename T>
+bool BasicExternalSorter<T>::collapse(BasicRangeList<T> &result)
+{
+    BasicRangeArray<T> ranges;
+    const bool ok = collapse([&ranges](const BasicRange<T> &range) {
+        ranges.append(range);
+    });
+    if (!ok) {
+        ranges.clear();
+    }
+    result.setCanonicalRanges(std::move(ranges));
+    return ok;
+}
+
+/*!
+ * \brief Collapses all the identifiers, and calls \a output with each canonical
+ * range, in increasing order.
+ * Returns false if a run can't be read or written.
+ *
+ * The canonical ranges are not stored, so that they can be written
+ * straight to a file or to an exporter.
+ *
+ * \warning The ranges are output while the runs are merged. If a run can't be
+ * read, the merge stops there and false is returned, but \a output may have
+ * already received the first canonical ranges. They're right, but the next
+ * ones are missing, and nothing is rolled back: discard what \a output
+ * received, like collapse(BasicRangeList<T> &) does.
+ */
+template <typename T>
+bool BasicExternalSorter<T>::collapse(const std::function<void(const BasicRange<T> &)> &output)
+{
+    if (hasError())
+        return false;
+
+    BasicRangeArray<T> ranges;
+    RangePacker<T> packer(&ranges);
+    auto flush = [&ranges, &output]() {
+        for (const BasicRange<T> &range : ranges) {
+            output(range);
+        }
+        ranges.clear();
+    };
+
+    bool ok = true;
+    if (m_runs.isEmpty()) {
+        T *begin = m_buffer.data();
+        _q_radixSort(begin, m_buffer.count());
+        T *end = std::unique(begin, begin + m_buffer.count());
+        _q_pushSorted(begin, int(end - begin), packer);
+
+    } else {
+        ok = spill();
+
+        /* Merge the runs by groups, until they can be merged at once */
+        const int maxRuns = int(qMax(qint64(2), m_memoryLimit / (qint64(sizeof(T)) * C_MIN_BLOCK_SIZE) - 1));
+        while (ok && m_runs.count() > maxRuns) {
+            QTemporaryFile *merged = new QTemporaryFile();
+            if (!merged->open()) {
+                setError(QString("Cannot create temporary file: %0").arg(merged->errorString()));
+                delete merged;
+                ok = false;
+                break;
+            }
+            const QList<QTemporaryFile*> group = m_runs.mid(0, maxRuns);
+            ok = mergeRuns(group, [this, merged](const T *values, const int count) {
+                if (!_q_write(merged, values, count))
+                    setError(QString("Cannot write temporary file: %0").arg(merged->errorString()));
+            });
+            qDeleteAll(group);
+            m_runs = m_runs.mid(maxRuns);
+            m_runs.append(merged);
+            ok = ok && !hasError();
+        }
+
+        if (ok) {
+            ok = mergeRuns(m_runs, [&packer, &flush](const T *values, const int count) {
+                _q_pushSorted(values, count, packer);
+                flush();
+            });
+        }
+    }
+    packer.finish();
+    if (ok)
+        flush();
+
+    qDeleteAll(m_runs);
+    m_runs.clear();
+    m_buffer.clear();
+    m_buffer.squeeze();
+    m_buffer.reserve(bufferCapacity());
+    m_count = 0;
+    return ok;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+bool BasicExternalSorter<T>::hasError() const
+{
+    return !m_errorString.isEmpty();
+}
+
+template <typename T>
+QString BasicExternalSorter<T>::errorString() const
+{
+    return m_errorString;
+}
+
+template <typename T>
+void BasicExternalSorter<T>::setError(const QString &errorString)
+{
+    if (m_errorString.isEmpty())
+        m_errorString = errorString;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \internal
+ * \brief Returns the number of identifiers buffered before a spill.
+ * The radix sort needs a second buffer of the same size.
+ *
+ * The buffer is reserved to this capacity, so that appending to it
+ * never doubles its allocation beyond the memory limit.
+ */
+template <typename T>
+int BasicExternalSorter<T>::bufferCapacity() const
+{
+    const qint64 capacity = m_memoryLimit / (2 * qint64(sizeof(T)));
+    return int(qBound(qint64(C_MIN_BLOCK_SIZE), capacity, qint64(1) << 30));
+}
+
+/*!
+ * \internal
+ * \brief Sorts and deduplicates the buffer, then writes it to a new temporary file.
+ */
+template <typename T>
+bool BasicExternalSorter<T>::spill()
+{
+    if (hasError())
+        return false;
+    if (m_buffer.isEmpty())
+        return true;
+
+    T *begin = m_buffer.data();
+    _q_radixSort(begin, m_buffer.count());
+    T *end = std::unique(begin, begin + m_buffer.count());
+
+    QTemporaryFile *run = new QTemporaryFile();
+    if (!run->open()) {
+        setError(QString("Cannot create temporary file: %0").arg(run->errorString()));
+        delete run;
+        return false;
+    }
+    if (!_q_write(run, begin, int(end - begin))) {
+        setError(QString("Cannot write temporary file: %0").arg(run->errorString()));
+        delete run;
+        return false;
+    }
+    m_runs.append(run);
+    m_buffer.clear();
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Merges the sorted \a runs with a k-way merge, and calls \a output with
+ * each block of merged identifiers, sorted and without duplicates.
+ *
+ * Each run, and the output, has a block of the memory limit.
+ */
+template <typename T>
+bool BasicExternalSorter<T>::mergeRuns(const QList<QTemporaryFile*> &runs,
+                                       const std::function<void(const T *, int)> &output)
+{
+    const int k = runs.count();
+    const int blockSize = int(qBound(qint64(C_MIN_BLOCK_SIZE),
+                                     m_memoryLimit / (qint64(sizeof(T)) * (k + 1)),
+                                     qint64(1) << 26));
+
+    QVector<RunReader<T> > readers(k);
+    QVector<RunHead<T> > heap;
+    heap.reserve(k);
+    for (int i = 0; i < k; ++i) {
+        RunReader<T> &reader = readers[i];
+        reader.file = runs.at(i);
+        reader.block.resize(blockSize);
+        if (!reader.file->seek(0)) {
+            setError(QString("Cannot read temporary file: %0").arg(reader.file->errorString()));
+            return false;
+        }
+        if (reader.fill()) {
+            RunHead<T> head = { reader.block.at(0), i };
+            heap.append(head);
+        } else if (reader.failed) {
+            setError(QString("Cannot read temporary file: %0").arg(reader.file->errorString()));
+            return false;
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), _q_headGreaterThan<T>);
+
+    QVector<T> merged(blockSize);
+    T *out = merged.data();
+    int outCount = 0;
+    T last = 0;
+    while (!heap.isEmpty()) {
+        std::pop_heap(heap.begin(), heap.end(), _q_headGreaterThan<T>);
+        RunHead<T> &head = heap.last();
+
+        /* Identifiers are strictly positive, so the first one is never skipped */
+        if (head.value != last) {
+            if (outCount == merged.count()) {
+                output(out, outCount);
+                outCount = 0;
+            }
+            out[outCount++] = head.value;
+            last = head.value;
+        }
+
+        RunReader<T> &reader = readers[head.run];
+        if (++reader.position < reader.size || reader.fill()) {
+            head.value = reader.block.at(reader.position);
+            std::push_heap(heap.begin(), heap.end(), _q_headGreaterThan<T>);
+        } else if (reader.failed) {
+            /* Stop here, so that the output is only missing the next identifiers */
+            setError(QString("Cannot read temporary file: %0").arg(reader.file->errorString()));
+            return false;
+        } else {
+            heap.removeLast();
+        }
+    }
+    if (outCount > 0)
+        output(out, outCount);
+
+    return !hasError();
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template class BasicExternalSorter<Identifier>;
+template class BasicExternalSorter<Identifier64>;
@@ -0,0 +1,103 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EXTERNALSORTER_H
+#define EXTERNALSORTER_H
+
+#include "rangelist.h"
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include <functional>
+
+class QTemporaryFile;
+
+/*!
+ * \class BasicExternalSorter
+ * \brief The BasicExternalSorter class collapses a stream of unsorted identifiers
+ * of type \a T into canonical ranges, with a bounded amount of memory.
+ *
+ * The identifiers are buffered until the memory limit is reached. Then the
+ * buffer is sorted, deduplicated and spilled to a temporary file, as a sorted run.
+ * At the end, the runs are merged with a k-way merge, and the merged stream is
+ * packed into canonical ranges while it's read.
+ *
+ * If the identifiers fit in memory, nothing is written to disk.
+ *
+ * Use ExternalSorter for 32-bit identifiers, and ExternalSorter64 for
+ * 64-bit identifiers.
+ */
+template <typename T>
+class BasicExternalSorter
+{
+    /* Q_DISABLE_COPY(BasicExternalSorter) */
+    BasicExternalSorter(const BasicExternalSorter &) = delete;
+    BasicExternalSorter &operator=(const BasicExternalSorter &) = delete;
+
+public:
+    explicit BasicExternalSorter(const qint64 memoryLimit = defaultMemoryLimit());
+    ~BasicExternalSorter();
+
+    static qint64 defaultMemoryLimit();
+
+    qint64 memoryLimit() const;
+    void setMemoryLimit(const qint64 bytes);
+
+    void clear();
+    qint64 count() const;
+    int countRuns() const;
+    QStringList runFileNames() const;
+    qint64 bufferSize() const;
+
+    bool add(const T identifier);
+    bool add(const QVector<T> &identifiers);
+    bool add(const BasicRange<T> &range);
+
+    bool collapse(BasicRangeList<T> &result);
+    bool collapse(const std::function<void(const BasicRange<T> &)> &output);
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    qint64 m_memoryLimit; ///< Peak memory, in bytes, used by the buffers.
+    qint64 m_count;       ///< Number of identifiers added, duplicates included.
+    QVector<T> m_buffer;  ///< Identifiers not spilled yet.
+    QList<QTemporaryFile*> m_runs; ///< Spilled runs, sorted and without duplicates.
+    QString m_errorString;
+
+    int bufferCapacity() const;
+    bool spill();
+    bool mergeRuns(const QList<QTemporaryFile*> &runs,
+                   const std::function<void(const T *, int)> &output);
+    void setError(const QString &errorString);
+};
+
+typedef BasicExternalSorter<Identifier> ExternalSorter;
+typedef BasicExternalSorter<Identifier64> ExternalSorter64;
+
+#endif // EXTERNALSORTER_H
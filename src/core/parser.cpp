@@ -23,12 +23,35 @@
  */
 
 #include "parser.h"
+#include "decimal_p.h"
+#include "rangelistbuilder.h"
 
-#include <QtCore/QRegularExpression>
+#include <QtCore/QIODevice>
 #include <QtCore/QList>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 #include <QtCore/QDebug>
 
+#include <cstring>
+
+/*
+ * The lines markers generally found in the Patran Session files
+ * are skipped, joining the text before and after them.
+ * Example:          [ "Node 681" // @\n"350:681400" ]
+ *           becomes [ "Node 681350:681400" ]
+ */
+static const char C_PATRAN_LINE_MARKER[] = "\" // @\n\"";
+static const int C_PATRAN_LINE_MARKER_LENGTH = 8;
+
+static const int C_MAX_KEYWORD_LENGTH = 6; // EXCEPT
+static const quint64 C_MAX_POSITIVE = Q_UINT64_C(9223372036854775807);
+static const quint64 C_MAX_NEGATIVE = Q_UINT64_C(9223372036854775808);
+
+/* The text of a QIODevice is read by chunks of 64 KB, and the identifiers
+   are canonicalized by batches of about one million */
+static const int C_STREAM_CHUNK_SIZE = 1 << 16;
+static const int C_STREAM_FLUSH_COUNT = 1 << 20;
+
 /*!
  * \class Parser
  * \brief The Parser class parses an input text and returns a list of ranges.
@@ -81,168 +104,785 @@ void Parser::deleteInstance()
 /*!
  * \brief Parses a input text and returns a list of ranges.
  * Rem: the returned ranges might contains duplicates, and entries might be unsorted.
+ *
+ * The identifiers greater than Range::maximum() are ignored.
+ * Use parse64() to parse 64-bit identifiers.
  */
 RangeListPtr Parser::parse(const QString &text) const
 {
     RangeListPtr ret(new RangeList);
+    parse(text, *ret);
+    return ret;
+}
 
-    Token current;
-    Token next;
-    QList<Token> tokens = tokenize(text);
+/*!
+ * \brief Parses a input text and returns a list of 64-bit ranges.
+ * \sa parse()
+ */
+RangeList64Ptr Parser::parse64(const QString &text) const
+{
+    RangeList64Ptr ret(new RangeList64);
+    parse64(text, *ret);
+    return ret;
+}
 
-    const int count = tokens.count();
-    for (int i = 0; i < count; ++i) {
+/*!
+ * \brief Parses a input text encoded in UTF-8 or Latin-1,
+ * and returns a list of ranges.
+ *
+ * The bytes are parsed as they are, without conversion to a QString:
+ * the numbers, the separators and the keywords are ASCII anyway.
+ * \sa parse()
+ */
+RangeListPtr Parser::parse(const QByteArray &text) const
+{
+    RangeListPtr ret(new RangeList);
+    parse(text, *ret);
+    return ret;
+}
 
-        current = tokens.at(i);
-        if (i < count-1) { next = tokens.at(i+1); } else { next.type = TOKEN_STREAM_END;}
+/*!
+ * \brief Parses a input text encoded in UTF-8 or Latin-1,
+ * and returns a list of 64-bit ranges.
+ * \sa parse()
+ */
+RangeList64Ptr Parser::parse64(const QByteArray &text) const
+{
+    RangeList64Ptr ret(new RangeList64);
+    parse64(text, *ret);
+    return ret;
+}
 
-        if ( next.type == TOKEN_NUMBER ||
-             next.type == TOKEN_UNKNOWN ||
-             next.type == TOKEN_STREAM_END ) {
-            /* Value as Number */
+/*!
+ * \brief Parses a input text into the caller-owned \a result.
+ *
+ * The previous content of \a result is cleared.
+ * Unlike the overload returning a RangeListPtr, the result itself isn't
+ * allocated on the heap.
+ */
+void Parser::parse(const QString &text, RangeList &result) const
+{
+    const ushort *begin = text.utf16();
+    parseAs<Identifier>(begin, begin + text.size(), result);
+}
 
-            if (current.type == TOKEN_NUMBER && current.value > 0) {
-                Range r(current.value);
-                ret->add(r);
-                continue;
-            }
+/*!
+ * \brief Parses a input text into the caller-owned 64-bit \a result.
+ * \sa parse()
+ */
+void Parser::parse64(const QString &text, RangeList64 &result) const
+{
+    const ushort *begin = text.utf16();
+    parseAs<Identifier64>(begin, begin + text.size(), result);
+}
 
-        } else if (next.type == TOKEN_THRU) {
-            /* Value as Range */
+/*!
+ * \brief Parses a input text encoded in UTF-8 or Latin-1,
+ * into the caller-owned \a result.
+ * \sa parse()
+ */
+void Parser::parse(const QByteArray &text, RangeList &result) const
+{
+    parse(text.constData(), text.size(), result);
+}
 
-            int _from = current.value;
-            int _to = 0;
-            int _by = 0;
-
-            i++;
-            i++;
-            if (i < count) {
-                current = tokens.at(i);
-                if (i < count-1) { next = tokens.at(i+1); } else { next.type = TOKEN_UNKNOWN;}
-
-                _to = current.value;
-
-                if (next.type == TOKEN_STEP) {
-                    i++;
-                    i++;
-                    if (i < count) {
-                        current = tokens.at(i);
-                        _by = current.value;
-                    }
-                }
-            }
-
-            if ((_by >= 0 && _to >= _from) || (_by < 0 && _from >= _to)) {
-                Range r(_from, _to, _by);
-                ret->add(r);
-            } else {
-                // Error message
-                // qDebug() << "Cannot parse '" << _from << "to" << _to << "'.";
-                // qDebug() <<"The second value MUST be greater than the first value.";
-            }
-            continue;
+/*!
+ * \brief Parses a input text encoded in UTF-8 or Latin-1,
+ * into the caller-owned 64-bit \a result.
+ * \sa parse()
+ */
+void Parser::parse64(const QByteArray &text, RangeList64 &result) const
+{
+    parse64(text.constData(), text.size(), result);
+}
+
+/*!
+ * \brief Parses the \a size bytes of \a text, encoded in UTF-8 or Latin-1,
+ * into the caller-owned \a result.
+ *
+ * The \a text buffer is read in place, for instance a memory-mapped file.
+ * \sa parse()
+ */
+void Parser::parse(const char *text, const int size, RangeList &result) const
+{
+    parseAs<Identifier>(text, text + size, result);
+}
+
+/*!
+ * \brief Parses the \a size bytes of \a text, encoded in UTF-8 or Latin-1,
+ * into the caller-owned 64-bit \a result.
+ * \sa parse()
+ */
+void Parser::parse64(const char *text, const int size, RangeList64 &result) const
+{
+    parseAs<Identifier64>(text, text + size, result);
+}
 
+/*!
+ * \brief Parses the text read from the \a device, encoded in UTF-8 or Latin-1,
+ * into the caller-owned \a result.
+ *
+ * The \a device, e.g. a QFile, a QProcess or a QLocalSocket, must be open for
+ * reading. It's read until its end by chunks of 64 KB, thus the memory used
+ * doesn't depend on the size of the text, but only on the parsed ranges.
+ *
+ * Returns false, with \a result unchanged, if the \a device can't be read.
+ * \sa parse()
+ */
+bool Parser::parse(QIODevice *device, RangeList &result) const
+{
+    return parseAs<Identifier>(device, result);
+}
+
+/*!
+ * \brief Parses the text read from the \a device, encoded in UTF-8 or Latin-1,
+ * into the caller-owned 64-bit \a result.
+ * \sa parse()
+ */
+bool Parser::parse64(QIODevice *device, RangeList64 &result) const
+{
+    return parseAs<Identifier64>(device, result);
+}
+
+/*!
+ * \internal
+ * \brief Returns the token \a value, or 0 if it doesn't fit in a BasicRange<T>.
+ */
+template <typename T>
+static inline T _q_narrow(const qint64 value)
+{
+    const qint64 max = BasicRange<T>::maximum();
+    return (value > max || value < -max) ? 0 : T(value);
+}
+
+/*!
+ * \internal
+ * \class Parser::TokenParser
+ * \brief The TokenParser class reads the tokens one by one, as the tokenizer
+ * produces them, and adds the identifiers and the ranges they describe.
+ *
+ * The grammar is run as a state machine, with a lookahead of one token:
+ * a number followed by THRU starts a range, and a range followed by BY or STEP
+ * gets a step. Thus, the tokens are never stored.
+ *
+ * \code
+ *   41 THRU 50 BY 3
+ *   ^  ^    ^  ^  ^
+ *   |  |    |  |  STATE_BY -> adds "41:50:3"
+ *   |  |    |  STATE_AFTER_TO
+ *   |  |    STATE_TO
+ *   |  STATE_CURRENT
+ *   STATE_NONE
+ * \endcode
+ */
+template <typename T>
+class Parser::TokenParser
+{
+public:
+    explicit TokenParser() : m_state(STATE_NONE), m_from(0), m_to(0) {}
+
+    void push(const Token &token);
+    void pushBlock(const BasicRangeBlock<T> &block);
+    void pushSegment(Segment &segment);
+
+    int pendingCount() const { return m_builder.count(); }
+    void flush(BasicRangeList<T> &result) { m_builder.finish(result); }
+    void finish(BasicRangeList<T> &result);
+
+private:
+    enum State {
+        STATE_NONE,         ///< No pending token.
+        STATE_CURRENT,      ///< The current token waits for the next one.
+        STATE_TO,           ///< "from THRU" waits for the last value.
+        STATE_AFTER_TO,     ///< "from THRU to" waits for a step.
+        STATE_BY            ///< "from THRU to BY" waits for the step value.
+    };
+
+    void addNumber(const Token &token);
+    void addRange(const T by);
+
+    BasicRangeListBuilder<T> m_builder; ///< The tokens, often thousands of
+    ///  unpacked values, are canonicalized at once.
+    State m_state;
+    Token m_current;
+    T m_from;
+    T m_to;
+};
+
+template <typename T>
+inline void Parser::TokenParser<T>::push(const Token &token)
+{
+    switch (m_state) {
+    case STATE_NONE:
+        m_current = token;
+        m_state = STATE_CURRENT;
+        break;
+
+    case STATE_CURRENT:
+        if (token.type == TOKEN_THRU) {
+            /* Value as Range */
+            m_from = _q_narrow<T>(m_current.value);
+            m_state = STATE_TO;
+            break;
+        }
+        if (token.type == TOKEN_NUMBER || token.type == TOKEN_UNKNOWN) {
+            /* Value as Number */
+            addNumber(m_current);
         } else {
             // ERROR ?
             Q_ASSERT(false);
         }
+        m_current = token;
+        break;
+
+    case STATE_TO:
+        m_to = _q_narrow<T>(token.value);
+        m_state = STATE_AFTER_TO;
+        break;
+
+    case STATE_AFTER_TO:
+        if (token.type == TOKEN_STEP) {
+            m_state = STATE_BY;
+            break;
+        }
+        addRange(0);
+        m_current = token;
+        m_state = STATE_CURRENT;
+        break;
+
+    case STATE_BY:
+        addRange(_q_narrow<T>(token.value));
+        m_state = STATE_NONE;
+        break;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Adds the identifiers of the \a block.
+ *
+ * Like an unknown token, the block ends the pending number or range,
+ * and can't be the bound of a range.
+ */
+template <typename T>
+inline void Parser::TokenParser<T>::pushBlock(const BasicRangeBlock<T> &block)
+{
+    push(Token(TOKEN_UNKNOWN));
+    m_builder.add(block);
+}
 
+/*!
+ * \internal
+ * \brief Ends the stream of tokens, and canonicalizes the identifiers
+ * and the ranges into \a result.
+ */
+template <typename T>
+void Parser::TokenParser<T>::finish(BasicRangeList<T> &result)
+{
+    switch (m_state) {
+    case STATE_NONE:
+        break;
+    case STATE_CURRENT:
+        addNumber(m_current);
+        break;
+    case STATE_TO:
+        m_to = 0;
+        addRange(0);
+        break;
+    case STATE_AFTER_TO:
+    case STATE_BY:
+        addRange(0);
+        break;
     }
-    return ret;
+    m_state = STATE_NONE;
+    m_builder.finish(result);
+}
+
+template <typename T>
+inline void Parser::TokenParser<T>::addNumber(const Token &token)
+{
+    if (token.type == TOKEN_NUMBER && _q_narrow<T>(token.value) > 0)
+        m_builder.add(_q_narrow<T>(token.value));
 }
 
-static inline QString depatranize(const QString &text)
+template <typename T>
+inline void Parser::TokenParser<T>::addRange(const T by)
 {
-    /*
-     * Remove the lines markers generally found
-     * in the Patran Session files.
-     * Example:          [ "Node 681" // @\n"350:681400" ]
-     *           becomes [ "Node 681350:681400" ]
-     */
+    if ((by >= 0 && m_to >= m_from) || (by < 0 && m_from >= m_to)) {
+        BasicRange<T> r(m_from, m_to, by);
+        m_builder.add(r);
+    } else {
+        // Error message
+        // qDebug() << "Cannot parse '" << m_from << "to" << m_to << "'.";
+        // qDebug() <<"The second value MUST be greater than the first value.";
+    }
+}
 
-    QString ret = text;
-    ret.replace(QLatin1String("\" // @\n\""), QLatin1String(""), Qt::CaseInsensitive);
-    return ret;
+/*!
+ * \internal
+ * \brief Parses the characters from \a begin to \a end into \a result,
+ * whose previous content is cleared.
+ *
+ * \a Char is either ushort, for the UTF-16 text of a QString,
+ * or char, for a text encoded in UTF-8 or Latin-1.
+ */
+template <typename T, typename Char>
+void Parser::parseAs(const Char *begin, const Char *end, BasicRangeList<T> &result) const
+{
+    TokenParser<T> parser;
+    Segment segment;
+    tokenize(begin, end, true, segment, parser);
+    result.clear();
+    parser.finish(result);
 }
 
-QList<Parser::Token> Parser::tokenize(const QString &text) const
+/*!
+ * \internal
+ * \brief Parses the text read from the \a device, chunk by chunk.
+ *
+ * Only the current chunk is held in memory, with the few characters of a line
+ * marker cut by the end of the previous chunk. The tokens are pushed as they
+ * are read, and the pending identifiers are canonicalized from time to time.
+ */
+template <typename T>
+bool Parser::parseAs(QIODevice *device, BasicRangeList<T> &result) const
 {
-    QList<Token> ret;
+    if (!device || !device->isReadable())
+        return false;
+
+    TokenParser<T> parser;
+    Segment segment;
+    BasicRangeList<T> parsed;
+
+    QByteArray buffer(C_STREAM_CHUNK_SIZE + C_PATRAN_LINE_MARKER_LENGTH, Qt::Uninitialized);
+    char *const data = buffer.data();
+    int carried = 0;
+
+    for (;;) {
+        const qint64 count = device->read(data + carried, C_STREAM_CHUNK_SIZE);
+        if (count < 0)
+            return false;
+        /* A pipe or a process can have no data available yet */
+        if (count == 0 && device->waitForReadyRead(-1))
+            continue;
 
-    if (text.isEmpty())
-        return ret;
+        const bool atEnd = (count == 0);
+        const char *const end = data + carried + count;
+        const char *rest = tokenize<T, char>(data, end, atEnd, segment, parser);
+        carried = int(end - rest);
+        std::memmove(data, rest, size_t(carried));
+        if (atEnd)
+            break;
 
-    const QString depatranized = depatranize(text);
+        if (parser.pendingCount() >= C_STREAM_FLUSH_COUNT)
+            parser.flush(parsed);
+    }
+    parser.finish(parsed);
+    result = parsed;
+    return true;
+}
 
-    QRegularExpression rx_separation_chars("(\\ |\\,|\\.|\\;|\\'|\\\"|\\t|\\r|\\n)");
-    QRegularExpression rx_colon_range("^(?<from>\\d+)(:(?<to>\\d+)(:(?<by>[+-]?\\d+))?)?$");
-    QRegularExpression rx_dash_range("^(?<from>\\d+)-(?<to>\\d+)$");
-    QRegularExpression rx_negative_number("^-\\d+$");
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \internal
+ * \brief Returns the position after the lines markers found at \a it.
+ */
+template <typename Char>
+static inline const Char *_q_skipLineMarkers(const Char *it, const Char *end)
+{
+    while (end - it >= C_PATRAN_LINE_MARKER_LENGTH
+           && *it == Char(C_PATRAN_LINE_MARKER[0])) {
+        for (int i = 1; i < C_PATRAN_LINE_MARKER_LENGTH; ++i) {
+            if (it[i] != Char(C_PATRAN_LINE_MARKER[i]))
+                return it;
+        }
+        it += C_PATRAN_LINE_MARKER_LENGTH;
+    }
+    return it;
+}
 
-    QStringList segments = depatranized.split(rx_separation_chars, QString::SkipEmptyParts);
+static inline ushort _q_unicode(const ushort c) { return c; }
+static inline ushort _q_unicode(const char c) { return uchar(c); }
 
-    for(auto segment : segments) {
+static inline bool _q_isSeparator(const ushort c)
+{
+    switch (c) {
+    case ' ': case ',': case '.': case ';': case '\'': case '"':
+    case '\t': case '\r': case '\n':
+        return true;
+    default:
+        return false;
+    }
+}
 
-        if (0 == QString::compare(segment, "THRU", Qt::CaseInsensitive)) {
-            ret << Token(TOKEN_THRU);
-            continue;
+/*!
+ * \internal
+ * \brief The Segment struct is the state of the scanner
+ * in the current segment, i.e. in the text between two separators.
+ *
+ * A segment is either a keyword (THRU, BY, STEP or EXCEPT),
+ * a number, a range "from:to", "from:to:by" or "from-to",
+ * a negative number, a block "[run]:lastFrom:period" as written by
+ * RangeHelper, or else it's unknown.
+ */
+struct Parser::Segment
+{
+    enum State {
+        STATE_START,
+        STATE_FROM,             // "15"
+        STATE_TO_START,         // "15:"
+        STATE_TO,               // "15:20"
+        STATE_BY_START,         // "15:20:"
+        STATE_BY_SIGN,          // "15:20:-"
+        STATE_BY,               // "15:20:-1"
+        STATE_DASH,             // "15-"
+        STATE_DASH_TO,          // "15-20"
+        STATE_NEGATIVE_SIGN,    // "-"
+        STATE_NEGATIVE,         // "-15"
+        STATE_KEYWORD,          // "THRU"
+        STATE_BLOCK_START,      // "["
+        STATE_BLOCK_FROM,       // "[122"
+        STATE_BLOCK_TO_START,   // "[122:"
+        STATE_BLOCK_TO,         // "[122:123"
+        STATE_BLOCK_BY_START,   // "[122:123:"
+        STATE_BLOCK_BY,         // "[122:123:1"
+        STATE_BLOCK_END,        // "[122:123]"
+        STATE_LAST_START,       // "[122:123]:"
+        STATE_LAST,             // "[122:123]:142"
+        STATE_PERIOD_START,     // "[122:123]:142:"
+        STATE_PERIOD,           // "[122:123]:142:10"
+        STATE_UNKNOWN
+    };
+
+    explicit Segment() { clear(); }
+
+    void clear()
+    {
+        state = STATE_START;
+        for (int i = 0; i < 5; ++i) {
+            values[i] = 0;
+            overflows[i] = false;
+            negatives[i] = false;
         }
-        if (0 == QString::compare(segment, "BY", Qt::CaseInsensitive)) {
-            ret << Token(TOKEN_STEP);
-            continue;
+        keywordLength = 0;
+    }
+
+    qint64 value(const int i) const
+    {
+        if (overflows[i])
+            return 0;
+        return negatives[i] ? qint64(0 - values[i]) : qint64(values[i]);
+    }
+
+    template <typename Char>
+    const Char *read(const Char *it, const Char *end);
+    bool isKeyword(const char *word) const;
+
+    State state;
+    quint64 values[5];  ///< Absolute values of from, to and by,
+    ///  then of the first identifier of the last run and of the period of a block.
+    bool overflows[5];
+    bool negatives[5];
+    char keyword[C_MAX_KEYWORD_LENGTH];
+    int keywordLength;
+};
+
+/*!
+ * \internal
+ * \brief Reads the next character of the segment at \a it, or the whole run
+ * of digits starting at \a it. Returns the position after the read characters.
+ */
+template <typename Char>
+inline const Char *Parser::Segment::read(const Char *it, const Char *end)
+{
+    const ushort c = _q_unicode(*it);
+    switch (state) {
+    case STATE_START:
+        if (_q_isDigit(c)) {
+            state = STATE_FROM;
+            return _q_readDigits(it, end, values[0], overflows[0], C_MAX_POSITIVE);
+        } else if (c == '-') {
+            negatives[0] = true;
+            state = STATE_NEGATIVE_SIGN;
+        } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') {
+            keyword[keywordLength++] = char(c & ~0x20);
+            state = STATE_KEYWORD;
+        } else if (c == '[') {
+            state = STATE_BLOCK_START;
+        } else {
+            state = STATE_UNKNOWN;
         }
-        if (0 == QString::compare(segment, "STEP", Qt::CaseInsensitive)) {
-            ret << Token(TOKEN_STEP);
-            continue;
+        break;
+
+    case STATE_FROM:
+        if (_q_isDigit(c)) {
+            return _q_readDigits(it, end, values[0], overflows[0], C_MAX_POSITIVE);
+        } else if (c == ':') {
+            state = STATE_TO_START;
+        } else if (c == '-') {
+            state = STATE_DASH;
+        } else {
+            state = STATE_UNKNOWN;
         }
-        if (0 == QString::compare(segment, "EXCEPT", Qt::CaseInsensitive)) {
-            ret << Token(TOKEN_EXCEPT);
-            continue;
+        break;
+
+    case STATE_TO_START:
+    case STATE_TO:
+        if (_q_isDigit(c)) {
+            state = STATE_TO;
+            return _q_readDigits(it, end, values[1], overflows[1], C_MAX_POSITIVE);
+        } else if (c == ':' && state == STATE_TO) {
+            state = STATE_BY_START;
+        } else {
+            state = STATE_UNKNOWN;
         }
+        break;
 
-        QRegularExpressionMatch match_colon = rx_colon_range.match(segment);
-        if (match_colon.hasMatch()) {
-            bool ok;
-            int from = match_colon.captured("from").toInt(&ok);
-            Q_ASSERT(ok);
-            int to = match_colon.captured("to").toInt();
-            int by = match_colon.captured("by").toInt();
-            ret << Token(TOKEN_NUMBER, from);
-            if (to) {
-                ret << Token(TOKEN_THRU);
-                ret << Token(TOKEN_NUMBER, to);
-            }
-            if (by) {
-                ret << Token(TOKEN_STEP);
-                ret << Token(TOKEN_NUMBER, by);
-            }
-            continue;
+    case STATE_BY_START:
+        if (c == '+' || c == '-') {
+            negatives[2] = (c == '-');
+            state = STATE_BY_SIGN;
+            break;
+        }
+        // fall through
+    case STATE_BY_SIGN:
+    case STATE_BY:
+        if (_q_isDigit(c)) {
+            state = STATE_BY;
+            return _q_readDigits(it, end, values[2], overflows[2],
+                                 negatives[2] ? C_MAX_NEGATIVE : C_MAX_POSITIVE);
+        } else {
+            state = STATE_UNKNOWN;
         }
+        break;
 
-        QRegularExpressionMatch match_dash = rx_dash_range.match(segment);
-        if (match_dash.hasMatch()) {
-            bool ok;
-            int from = match_dash.captured("from").toInt(&ok);
-            Q_ASSERT(ok);
-            int to = match_dash.captured("to").toInt(&ok);
-            Q_ASSERT(ok);
-            ret << Token(TOKEN_NUMBER, from);
-            ret << Token(TOKEN_THRU);
-            ret << Token(TOKEN_NUMBER, to);
-            continue;
+    case STATE_DASH:
+    case STATE_DASH_TO:
+        if (_q_isDigit(c)) {
+            state = STATE_DASH_TO;
+            return _q_readDigits(it, end, values[1], overflows[1], C_MAX_POSITIVE);
+        } else {
+            state = STATE_UNKNOWN;
         }
+        break;
 
-        QRegularExpressionMatch match_number = rx_negative_number.match(segment);
-        if (match_number.hasMatch()) {
-            bool ok;
-            int value = segment.toInt(&ok);
-            Q_ASSERT(ok);
-            ret << Token(TOKEN_NUMBER, value);
-            continue;
+    case STATE_NEGATIVE_SIGN:
+    case STATE_NEGATIVE:
+        if (_q_isDigit(c)) {
+            state = STATE_NEGATIVE;
+            return _q_readDigits(it, end, values[0], overflows[0], C_MAX_NEGATIVE);
+        } else {
+            state = STATE_UNKNOWN;
         }
+        break;
 
-        ret << Token(TOKEN_UNKNOWN);
+    case STATE_KEYWORD:
+        if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z' && keywordLength < C_MAX_KEYWORD_LENGTH) {
+            keyword[keywordLength++] = char(c & ~0x20);
+        } else {
+            state = STATE_UNKNOWN;
+        }
+        break;
+
+    case STATE_BLOCK_START:
+    case STATE_BLOCK_FROM:
+        if (_q_isDigit(c)) {
+            state = STATE_BLOCK_FROM;
+            return _q_readDigits(it, end, values[0], overflows[0], C_MAX_POSITIVE);
+        } else if (c == ':' && state == STATE_BLOCK_FROM) {
+            state = STATE_BLOCK_TO_START;
+        } else if (c == ']' && state == STATE_BLOCK_FROM) {
+            state = STATE_BLOCK_END;
+        } else {
+            state = STATE_UNKNOWN;
+        }
+        break;
+
+    case STATE_BLOCK_TO_START:
+    case STATE_BLOCK_TO:
+        if (_q_isDigit(c)) {
+            state = STATE_BLOCK_TO;
+            return _q_readDigits(it, end, values[1], overflows[1], C_MAX_POSITIVE);
+        } else if (c == ':' && state == STATE_BLOCK_TO) {
+            state = STATE_BLOCK_BY_START;
+        } else if (c == ']' && state == STATE_BLOCK_TO) {
+            state = STATE_BLOCK_END;
+        } else {
+            state = STATE_UNKNOWN;
+        }
+        break;
+
+    case STATE_BLOCK_BY_START:
+    case STATE_BLOCK_BY:
+        if (_q_isDigit(c)) {
+            state = STATE_BLOCK_BY;
+            return _q_readDigits(it, end, values[2], overflows[2], C_MAX_POSITIVE);
+        } else if (c == ']' && state == STATE_BLOCK_BY) {
+            state = STATE_BLOCK_END;
+        } else {
+            state = STATE_UNKNOWN;
+        }
+        break;
+
+    case STATE_BLOCK_END:
+        state = (c == ':') ? STATE_LAST_START : STATE_UNKNOWN;
+        break;
+
+    case STATE_LAST_START:
+    case STATE_LAST:
+        if (_q_isDigit(c)) {
+            state = STATE_LAST;
+            return _q_readDigits(it, end, values[3], overflows[3], C_MAX_POSITIVE);
+        } else if (c == ':' && state == STATE_LAST) {
+            state = STATE_PERIOD_START;
+        } else {
+            state = STATE_UNKNOWN;
+        }
+        break;
 
+    case STATE_PERIOD_START:
+    case STATE_PERIOD:
+        if (_q_isDigit(c)) {
+            state = STATE_PERIOD;
+            return _q_readDigits(it, end, values[4], overflows[4], C_MAX_POSITIVE);
+        } else {
+            state = STATE_UNKNOWN;
+        }
+        break;
+
+    case STATE_UNKNOWN:
+        break;
+    }
+    return it + 1;
+}
+
+inline bool Parser::Segment::isKeyword(const char *word) const
+{
+    return keywordLength == int(qstrlen(word))
+            && 0 == qstrncmp(keyword, word, uint(keywordLength));
+}
+
+/*!
+ * \internal
+ * \brief Returns the block of the run \a from:\a to:\a by, repeated every
+ * \a period identifiers up to the run starting at \a lastFrom.
+ * Returns an empty block if the runs don't fit this progression.
+ *
+ * Example:
+ *    "[122:123]:142:10" -> the run 122:123, repeated 3 times every 10 identifiers
+ */
+template <typename T>
+static inline BasicRangeBlock<T> _q_toBlock(const qint64 from, const qint64 to, const qint64 by,
+                                            const qint64 lastFrom, const qint64 period)
+{
+    const BasicRange<T> run(_q_narrow<T>(from), _q_narrow<T>(to), _q_narrow<T>(by));
+    if (run.isEmpty() || run.from() != from || period <= 0 || lastFrom < from
+            || (lastFrom - from) % period != 0) {
+        return BasicRangeBlock<T>();
+    }
+    const qint64 repeat = (lastFrom - from) / period + 1;
+    if (repeat > BasicRange<T>::maximum() || period > BasicRange<T>::maximum())
+        return BasicRangeBlock<T>();
+    return BasicRangeBlock<T>(run, T(period), T(repeat));
+}
+
+/*!
+ * \internal
+ * \brief Pushes the tokens of the \a segment, and clears it.
+ */
+template <typename T>
+void Parser::TokenParser<T>::pushSegment(Segment &segment)
+{
+    if (segment.state == Segment::STATE_START)
+        return;
+
+    switch (segment.state) {
+    case Segment::STATE_FROM:
+    case Segment::STATE_TO:
+    case Segment::STATE_BY:
+        push(Token(TOKEN_NUMBER, segment.value(0)));
+        if (segment.value(1)) {
+            push(Token(TOKEN_THRU));
+            push(Token(TOKEN_NUMBER, segment.value(1)));
+        }
+        if (segment.value(2)) {
+            push(Token(TOKEN_STEP));
+            push(Token(TOKEN_NUMBER, segment.value(2)));
+        }
+        break;
+
+    case Segment::STATE_DASH_TO:
+        push(Token(TOKEN_NUMBER, segment.value(0)));
+        push(Token(TOKEN_THRU));
+        push(Token(TOKEN_NUMBER, segment.value(1)));
+        break;
+
+    case Segment::STATE_NEGATIVE:
+        push(Token(TOKEN_NUMBER, segment.value(0)));
+        break;
+
+    case Segment::STATE_PERIOD:
+        pushBlock(_q_toBlock<T>(segment.value(0), segment.value(1), segment.value(2),
+                                segment.value(3), segment.value(4)));
+        break;
+
+    case Segment::STATE_KEYWORD:
+        if (segment.isKeyword("THRU")) {
+            push(Token(TOKEN_THRU));
+        } else if (segment.isKeyword("BY") || segment.isKeyword("STEP")) {
+            push(Token(TOKEN_STEP));
+        } else if (segment.isKeyword("EXCEPT")) {
+            push(Token(TOKEN_EXCEPT));
+        } else {
+            push(Token(TOKEN_UNKNOWN));
+        }
+        break;
+
+    default:
+        push(Token(TOKEN_UNKNOWN));
+        break;
+    }
+    segment.clear();
+}
+
+/*!
+ * \internal
+ * \brief Splits the text from \a begin to \a end into tokens,
+ * in a single pass over its characters,
+ * and pushes them to the \a parser as soon as they are read.
+ *
+ * The text is split by the separation characters (spaces, tabs, line feeds,
+ * and the characters ,.;'"), and each segment of text is read character
+ * by character, without being copied to a string. The runs of digits are
+ * converted at once, see _q_readDigits().
+ *
+ * The text can also be given part by part. Unless \a atEnd, the \a segment
+ * read at the end of the part is continued by the next part. Returns where
+ * the reading stopped: either \a end, or the beginning of a line marker
+ * cut by the end of the part, that must be given again with the next part.
+ */
+template <typename T, typename Char>
+const Char *Parser::tokenize(const Char *begin, const Char *end, const bool atEnd,
+                             Segment &segment, TokenParser<T> &parser) const
+{
+    const Char *it = begin;
+    for (;;) {
+        it = _q_skipLineMarkers(it, end);
+        if (it == end) {
+            if (atEnd)
+                parser.pushSegment(segment);
+            return end;
+        }
+        if (!atEnd && end - it < C_PATRAN_LINE_MARKER_LENGTH
+                && *it == Char(C_PATRAN_LINE_MARKER[0])) {
+            return it;
+        }
+        if (_q_isSeparator(_q_unicode(*it))) {
+            parser.pushSegment(segment);
+            ++it;
+        } else {
+            it = segment.read(it, end);
+        }
     }
-    return ret;
 }
@@ -27,6 +27,10 @@
 
 #include "rangelist.h"
 
+#include <QtCore/QByteArray>
+
+class QIODevice;
+
 class Parser
 {    
     /* Q_DISABLE_COPY(Parser) */
@@ -43,6 +47,19 @@ public:
     ~Parser();
 
     RangeListPtr parse(const QString &text) const;
+    RangeList64Ptr parse64(const QString &text) const;
+    RangeListPtr parse(const QByteArray &text) const;
+    RangeList64Ptr parse64(const QByteArray &text) const;
+
+    void parse(const QString &text, RangeList &result) const;
+    void parse64(const QString &text, RangeList64 &result) const;
+    void parse(const QByteArray &text, RangeList &result) const;
+    void parse64(const QByteArray &text, RangeList64 &result) const;
+    void parse(const char *text, const int size, RangeList &result) const;
+    void parse64(const char *text, const int size, RangeList64 &result) const;
+
+    bool parse(QIODevice *device, RangeList &result) const;
+    bool parse64(QIODevice *device, RangeList64 &result) const;
 
 private:
     enum TokenType {
@@ -56,12 +73,25 @@ private:
 
     struct Token {
         explicit Token() : type(TOKEN_UNKNOWN), value(-1) {}
-        explicit Token(TokenType _type, int _value = -1) : type(_type), value(_value) {}
+        explicit Token(TokenType _type, qint64 _value = -1) : type(_type), value(_value) {}
         TokenType type;
-        int value;
+        qint64 value;
     };
 
-    QList<Token> tokenize(const QString &text) const;
+    struct Segment;
+
+    template <typename T>
+    class TokenParser;
+
+    template <typename T, typename Char>
+    void parseAs(const Char *begin, const Char *end, BasicRangeList<T> &result) const;
+
+    template <typename T>
+    bool parseAs(QIODevice *device, BasicRangeList<T> &result) const;
+
+    template <typename T, typename Char>
+    const Char *tokenize(const Char *begin, const Char *end, const bool atEnd,
+                         Segment &segment, TokenParser<T> &parser) const;
 
 };
 
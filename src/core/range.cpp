@@ -23,13 +23,29 @@
  */
 
 #include "range.h"
+#include "range_p.h"
 
 #include <QtCore/QRegularExpression>
 #include <QtCore/QString>
+#include <QtCore/QVector>
+#include <algorithm>
+#include <limits>
 
+template <typename T>
+static inline QList<BasicRange<T> > _q_toList(const BasicRangeArray<T> &ranges)
+{
+    QList<BasicRange<T> > res;
+    res.reserve(ranges.count());
+    foreach (auto range, ranges) {
+        res.append(range);
+    }
+    return res;
+}
 
-Range::Range(const Identifier _from,
-             const Identifier _to, const int _by)
+
+template <typename T>
+BasicRange<T>::BasicRange(const T _from,
+                          const T _to, const T _by)
     : m_from(_from)
     , m_to(_to)
     , m_by(_by)
@@ -37,12 +53,32 @@ Range::Range(const Identifier _from,
     this->simplify();
 }
 
-bool Range::isEmpty() const
+/*!
+ * \brief Returns the greatest identifier that a range can hold.
+ *
+ * 64-bit identifiers are bounded to 2^62 - 1, so that the set operations can
+ * step one range past any identifier without overflowing.
+ */
+template <>
+Identifier BasicRange<Identifier>::maximum()
+{
+    return std::numeric_limits<Identifier>::max();
+}
+
+template <>
+Identifier64 BasicRange<Identifier64>::maximum()
+{
+    return Q_INT64_C(0x3FFFFFFFFFFFFFFF);
+}
+
+template <typename T>
+bool BasicRange<T>::isEmpty() const
 {
     return (m_from == 0);
 }
 
-void Range::clear()
+template <typename T>
+void BasicRange<T>::clear()
 {
     m_from = 0;
     m_to = 0;
@@ -56,7 +92,8 @@ void Range::clear()
 /*!
  * \brief Returns the number of unique identifiers in the Range.
  */
-int Range::count() const
+template <typename T>
+T BasicRange<T>::count() const
 {
     if (m_from == 0) /* Empty range */
         return 0;
@@ -70,8 +107,9 @@ int Range::count() const
 
 /***********************************************************************************
  ***********************************************************************************/
-void Range::setRange(const Identifier _from,
-                     const Identifier _to, const int _by)
+template <typename T>
+void BasicRange<T>::setRange(const T _from,
+                             const T _to, const T _by)
 {
     m_from = _from;
     m_to = _to;
@@ -81,14 +119,16 @@ void Range::setRange(const Identifier _from,
 
 /***********************************************************************************
  ***********************************************************************************/
-bool Range::operator==(const Range &other) const
+template <typename T>
+bool BasicRange<T>::operator==(const BasicRange<T> &other) const
 {
     return (*this).m_from == other.m_from
             && (*this).m_to == other.m_to
             && (*this).m_by == other.m_by;
 }
 
-bool Range::operator!=(const Range &other) const
+template <typename T>
+bool BasicRange<T>::operator!=(const BasicRange<T> &other) const
 {
     return ((*this) == other) ? false : true;
 }
@@ -96,13 +136,145 @@ bool Range::operator!=(const Range &other) const
 
 /***********************************************************************************
  ***********************************************************************************/
-void Range::simplify()
+/*!
+ * \brief Returns true if the Range contains the given \a identifier.
+ */
+template <typename T>
+bool BasicRange<T>::contains(const T identifier) const
+{
+    if (isEmpty() || identifier < m_from || identifier > m_to)
+        return false;
+    return ((identifier - m_from) % m_by) == 0;
+}
+
+/*!
+ * \brief Returns the identifiers common to this Range and the \a other Range.
+ *
+ * The intersection of two progressions is always a progression, whose step is
+ * the LCM of both steps. It is computed with the Chinese remainder theorem,
+ * hence different steps and phases are handled exactly.
+ *
+ * \code
+ *   Range(1, 100, 4).intersected( Range(3, 100, 6) ); // returns "9:93:12"
+ *   Range(1, 100, 2).intersected( Range(2, 100, 2) ); // returns an empty range
+ * \endcode
+ */
+template <typename T>
+BasicRange<T> BasicRange<T>::intersected(const BasicRange<T> &other) const
+{
+    if (isEmpty() || other.isEmpty())
+        return BasicRange<T>();
+
+    const qint64 lo = qMax(m_from, other.m_from);
+    const qint64 hi = qMin(m_to, other.m_to);
+    qint64 first = 0;
+    qint64 step = 0;
+    if (lo > hi || !_q_meet(*this, other, lo, first, step) || first > hi)
+        return BasicRange<T>();
+
+    if (hi - first < step)
+        return BasicRange<T>(T(first));
+
+    const qint64 last = first + ((hi - first) / step) * step;
+    return BasicRange<T>(T(first), T(last), T(step));
+}
+
+/*!
+ * \brief Returns the identifiers of this Range that are not in the \a other Range.
+ *
+ * The result is returned as canonical ranges, i.e. packed like in RangeList.
+ *
+ * \code
+ *   Range(1, 20, 1).subtracted( Range(5, 15, 5) ); // returns {"1:4" "6:9" "11:14" "16:20"}
+ *   Range(1, 20, 1).subtracted( Range(2, 20, 2) ); // returns {"1:19:2"}
+ * \endcode
+ */
+template <typename T>
+QList<BasicRange<T> > BasicRange<T>::subtracted(const BasicRange<T> &other) const
+{
+    BasicRangeArray<T> res;
+    if (isEmpty())
+        return QList<BasicRange<T> >();
+
+    RangePacker<T> packer(&res);
+    if (other.isEmpty() || other.m_to < m_from || other.m_from > m_to) {
+        packer.push(m_from, m_to, m_by);
+    } else {
+        const qint64 lo = qMax(m_from, other.m_from);
+        const qint64 hi = qMin(m_to, other.m_to);
+        _q_push_between(*this, m_from, lo - 1, packer);
+        _q_subtract_window(*this, other, lo, hi, packer);
+        _q_push_between(*this, hi + 1, m_to, packer);
+    }
+    packer.finish();
+    return _q_toList(res);
+}
+
+/*!
+ * \brief Returns the identifiers that are in this Range or in the \a other Range.
+ *
+ * The result is returned as canonical ranges, i.e. packed like in RangeList.
+ *
+ * \code
+ *   Range(1, 99, 2).united( Range(2, 100, 2) ); // returns {"1:100"}
+ *   Range(1, 5, 1).united( Range(20, 30, 5) );  // returns {"1:5" "20:30:5"}
+ * \endcode
+ */
+template <typename T>
+QList<BasicRange<T> > BasicRange<T>::united(const BasicRange<T> &other) const
+{
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
+
+    const BasicRange<T> &r1 = (other.isEmpty() || (!isEmpty() && m_from <= other.m_from)) ? *this : other;
+    const BasicRange<T> &r2 = (&r1 == this) ? other : *this;
+
+    if (r2.isEmpty()) {
+        if (!r1.isEmpty()) {
+            packer.push(r1.m_from, r1.m_to, r1.m_by);
+        }
+
+    } else if (r2.m_from > r1.m_to) {
+        packer.push(r1.m_from, r1.m_to, r1.m_by);
+        packer.push(r2.m_from, r2.m_to, r2.m_by);
+
+    } else {
+        const qint64 lo = r2.m_from;
+        const qint64 hi = qMin(r1.m_to, r2.m_to);
+        _q_push_between(r1, r1.m_from, lo - 1, packer);
+
+        RangeCursorArray cursors(2);
+        cursors[0].next = r1.m_from + ((lo - r1.m_from + r1.m_by - 1) / r1.m_by) * r1.m_by;
+        cursors[0].to = r1.m_to;
+        cursors[0].by = r1.m_by;
+        cursors[1].next = r2.m_from;
+        cursors[1].to = r2.m_to;
+        cursors[1].by = r2.m_by;
+        _q_unite_window(cursors, lo, hi, packer);
+
+        const BasicRange<T> &last = (r1.m_to > r2.m_to) ? r1 : r2;
+        _q_push_between(last, hi + 1, last.m_to, packer);
+    }
+    packer.finish();
+    return _q_toList(res);
+}
+
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+void BasicRange<T>::simplify()
 {
     if (m_from <= 0) { /* Makes it an empty range */
         clear();
         return;
     }
 
+    if (m_from > maximum() || m_to > maximum() || m_to < -maximum()) {
+        clear(); /* Out of bounds */
+        return;
+    }
+
     if (m_to < 0) {
         m_to *= -1;
     }
@@ -120,7 +292,7 @@ void Range::simplify()
 
     if (m_from > m_to ) {
         /* Change direction */
-        int tmp = m_from;
+        T tmp = m_from;
         m_from = m_to;
         m_to = tmp;
 
@@ -128,7 +300,7 @@ void Range::simplify()
             m_by *= -1;
         }
         Q_ASSERT(m_by!=0);
-        int s = (m_to - m_from) / m_by;
+        T s = (m_to - m_from) / m_by;
         Q_ASSERT(s>=0);
         m_from = m_to - s * m_by;
 
@@ -138,7 +310,7 @@ void Range::simplify()
             m_by *= -1;
         }
         Q_ASSERT(m_by!=0);
-        int s = (m_to - m_from) / m_by;
+        T s = (m_to - m_from) / m_by;
         Q_ASSERT(s>=0);
         m_to = m_from + s * m_by;
 
@@ -160,3 +332,281 @@ void Range::simplify()
 
 }
 
+
+/***********************************************************************************
+ * KERNELS
+ ***********************************************************************************/
+/* Period length above which the sweep stops looking for a periodic pattern. */
+static const qint64 C_MAX_PERIOD = 4096;
+
+/* Step of the lattices that meet at most once, i.e. greater than any identifier. */
+static const qint64 C_INFINITE_STEP = Q_INT64_C(0x4000000000000000);
+
+/* Operands below this bound can be multiplied without overflow. */
+static const qint64 C_MAX_FACTOR = Q_INT64_C(0x7FFFFFFF);
+
+/*!
+ * \internal
+ * \brief Moves the \a cursor to its first identifier greater than \a value.
+ */
+static inline void _q_advance(RangeCursor &cursor, const qint64 value)
+{
+    if (cursor.next <= value) {
+        cursor.next += ((value - cursor.next) / cursor.by + 1) * cursor.by;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Pushes into the \a packer the union of the \a cursors over the
+ * window [\a pos, \a end], then moves the cursors past the window.
+ *
+ * All the cursors must cover the whole window.
+ * Cursors running on the same lattice are merged in one step. Interleaved cursors
+ * (like odd and even identifiers) are merged by repeating the pattern of one
+ * period, whose length is the LCM of the steps.
+ */
+template <typename T>
+void _q_unite_window(RangeCursorArray &cursors,
+                     const qint64 pos, const qint64 end,
+                     RangePacker<T> &packer)
+{
+    const int count = cursors.count();
+
+    if (count == 1) {
+        RangeCursor &c = cursors[0];
+        if (c.next <= end) {
+            packer.push(c.next, end, c.by);
+            _q_advance(c, end);
+        }
+        return;
+    }
+
+    /* Periodic pattern */
+    qint64 period = 1;
+    for (int i = 0; i < count && period <= C_MAX_PERIOD; ++i) {
+        const qint64 by = cursors.at(i).by;
+        period = (by > C_MAX_PERIOD) ? by : (period / _q_gcd(period, by)) * by;
+    }
+    if (period <= C_MAX_PERIOD && (end - pos + 1) >= 4 * period) {
+
+        QVector<qint64> pattern;
+        for (int i = 0; i < count; ++i) {
+            const RangeCursor &c = cursors.at(i);
+            for (qint64 v = c.next; v < pos + period; v += c.by) {
+                pattern.append(v);
+            }
+        }
+        std::sort(pattern.begin(), pattern.end());
+        pattern.erase(std::unique(pattern.begin(), pattern.end()), pattern.end());
+
+        const int n = pattern.count();
+        Q_ASSERT(n > 0);
+        const qint64 step = (n == 1) ? period : pattern.at(1) - pattern.at(0);
+        bool isProgression = (pattern.first() + period - pattern.last() == step);
+        for (int i = 1; i < n && isProgression; ++i) {
+            isProgression = (pattern.at(i) - pattern.at(i-1) == step);
+        }
+
+        if (isProgression) {
+            packer.push(pattern.first(), end, step);
+        } else {
+            /* Splits the pattern in progressions, then repeats them period by period. */
+            QVector<RangeCursor> pieces;
+            for (int i = 0; i < n; ) {
+                RangeCursor piece;
+                piece.next = pattern.at(i);
+                piece.to = pattern.at(i);
+                piece.by = 1;
+                int j = i + 1;
+                if (j < n) {
+                    piece.by = pattern.at(j) - pattern.at(i);
+                    while (j + 1 < n && pattern.at(j+1) - pattern.at(j) == piece.by) {
+                        j++;
+                    }
+                    piece.to = pattern.at(j);
+                }
+                pieces.append(piece);
+                i = j + 1;
+            }
+            for (qint64 base = 0; pattern.first() + base <= end; base += period) {
+                foreach (auto piece, pieces) {
+                    const qint64 from = piece.next + base;
+                    if (from > end)
+                        break;
+                    packer.push(from, qMin(piece.to + base, end), piece.by);
+                }
+            }
+        }
+        for (int i = 0; i < count; ++i) {
+            _q_advance(cursors[i], end);
+        }
+        return;
+    }
+
+    /* Lattice-by-lattice merge */
+    while (true) {
+        int p = -1;
+        for (int i = 0; i < count; ++i) {
+            const RangeCursor &c = cursors.at(i);
+            if (c.next > end)
+                continue;
+            if (p < 0
+                    || c.next < cursors.at(p).next
+                    || (c.next == cursors.at(p).next && c.by < cursors.at(p).by)) {
+                p = i;
+            }
+        }
+        if (p < 0)
+            break;
+
+        /* Extends the lattice of 'p' until an identifier of another cursor falls outside. */
+        const RangeCursor &lattice = cursors.at(p);
+        qint64 limit = end;
+        for (int i = 0; i < count; ++i) {
+            const RangeCursor &c = cursors.at(i);
+            if (i == p || c.next > limit)
+                continue;
+            qint64 outside = c.next;
+            if ((c.next - lattice.next) % lattice.by == 0) {
+                if (c.by % lattice.by == 0)
+                    continue;
+                outside = c.next + c.by;
+            }
+            if (outside <= c.to) {
+                limit = qMin(limit, outside - 1);
+            }
+        }
+        const qint64 last = lattice.next + ((limit - lattice.next) / lattice.by) * lattice.by;
+        packer.push(lattice.next, last, lattice.by);
+        for (int i = 0; i < count; ++i) {
+            _q_advance(cursors[i], last);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Returns the inverse of \a a modulo \a m, with \a a and \a m coprime.
+ */
+static inline qint64 _q_inverse(const qint64 a, const qint64 m)
+{
+    qint64 r0 = m, r1 = a % m;
+    qint64 s0 = 0, s1 = 1;
+    while (r1 != 0) {
+        const qint64 q = r0 / r1;
+        qint64 t = r0 - q * r1; r0 = r1; r1 = t;
+        t = s0 - q * s1; s0 = s1; s1 = t;
+    }
+    Q_ASSERT(r0 == 1);
+    return (s0 % m + m) % m;
+}
+
+/*!
+ * \internal
+ * \brief Returns \a a * \a b modulo \a m, with \a a, \a b and \a m lower
+ * than C_INFINITE_STEP.
+ */
+static inline qint64 _q_mulmod(qint64 a, qint64 b, const qint64 m)
+{
+    if (a <= C_MAX_FACTOR && b <= C_MAX_FACTOR)
+        return (a * b) % m;
+
+    /* Double-and-add, since the product may not fit in 64 bits. */
+    qint64 res = 0;
+    a %= m;
+    while (b > 0) {
+        if (b & 1) {
+            res = (res + a) % m;
+        }
+        a = (a + a) % m;
+        b >>= 1;
+    }
+    return res;
+}
+
+/*!
+ * \internal
+ * \brief Finds the first identifier greater or equal to \a lo that belongs to
+ * both \a r1 and \a r2 lattices (Chinese remainder theorem).
+ * Returns false if the lattices never meet. Otherwise, \a first is the identifier
+ * and \a step is the step of the common lattice, i.e. the LCM of the steps.
+ */
+template <typename T>
+bool _q_meet(const BasicRange<T> &r1, const BasicRange<T> &r2, const qint64 lo,
+             qint64 &first, qint64 &step)
+{
+    const qint64 by1 = r1.by();
+    const qint64 by2 = r2.by();
+    const qint64 g = _q_gcd(by1, by2);
+    const qint64 diff = qint64(r2.from()) - qint64(r1.from());
+    if (diff % g != 0)
+        return false;
+
+    /* Solve r1.from + k * by1 == r2.from (mod by2) */
+    const qint64 m = by2 / g;
+    qint64 k = 0;
+    if (m > 1) {
+        const qint64 d = ((diff / g) % m + m) % m;
+        k = _q_mulmod(d, _q_inverse((by1 / g) % m, m), m);
+    }
+    if (k > (C_INFINITE_STEP - r1.from()) / by1)
+        return false; /* They meet beyond any identifier */
+
+    step = (by1 / g > C_INFINITE_STEP / by2) ? C_INFINITE_STEP : (by1 / g) * by2;
+    const qint64 x = qint64(r1.from()) + k * by1;
+    first = (x >= lo) ? x - ((x - lo) / step) * step
+                      : x + ((lo - x + step - 1) / step) * step;
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Pushes into the \a packer the identifiers of \a range that are
+ * between \a lo and \a hi, but not in \a removed.
+ */
+template <typename T>
+void _q_subtract_window(const BasicRange<T> &range, const BasicRange<T> &removed,
+                        const qint64 lo, const qint64 hi,
+                        RangePacker<T> &packer)
+{
+    qint64 first = 0;
+    qint64 step = 0;
+    if (!_q_meet(range, removed, lo, first, step) || first > hi) {
+        _q_push_between(range, lo, hi, packer);
+        return;
+    }
+    const qint64 by = range.by();
+    const qint64 last = first + ((hi - first) / step) * step;
+    const qint64 ratio = step / by;
+
+    _q_push_between(range, lo, first - 1, packer);
+    if (ratio == 2) {
+        if (first + by < last) {
+            packer.push(first + by, last - by, step);
+        }
+    } else if (ratio > 2) {
+        for (qint64 x = first; x < last; x += step) {
+            packer.push(x + by, x + step - by, by);
+        }
+    }
+    _q_push_between(range, last + 1, hi, packer);
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template class BasicRange<Identifier>;
+template class BasicRange<Identifier64>;
+
+template void _q_unite_window(RangeCursorArray &, const qint64, const qint64,
+                              RangePacker<Identifier> &);
+template void _q_unite_window(RangeCursorArray &, const qint64, const qint64,
+                              RangePacker<Identifier64> &);
+
+template bool _q_meet(const Range &, const Range &, const qint64, qint64 &, qint64 &);
+template bool _q_meet(const Range64 &, const Range64 &, const qint64, qint64 &, qint64 &);
+
+template void _q_subtract_window(const Range &, const Range &,
+                                 const qint64, const qint64, RangePacker<Identifier> &);
+template void _q_subtract_window(const Range64 &, const Range64 &,
+                                 const qint64, const qint64, RangePacker<Identifier64> &);
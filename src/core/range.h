@@ -25,39 +25,120 @@
 #ifndef RANGE_H
 #define RANGE_H
 
+#include <QtCore/QList>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 typedef int Identifier;
+typedef qint64 Identifier64;
 
-class Range
+/*!
+ * \class BasicRange
+ * \brief The BasicRange class is a progression of identifiers of type \a T.
+ *
+ * Use Range for 32-bit identifiers, and Range64 for 64-bit identifiers.
+ */
+template <typename T>
+class BasicRange
 {
 public:
-    explicit Range(const Identifier _from = 0,
-                   const Identifier _to = 0, const int _by = 0);
+    explicit BasicRange(const T _from = 0,
+                        const T _to = 0, const T _by = 0);
+
+    static T maximum();
 
-    int count() const;
+    T count() const;
     bool isEmpty() const;
     void clear();
 
     /* Setters */
-    void setRange(const Identifier _from,
-                  const Identifier _to = 0, const int _by = 0);
+    void setRange(const T _from,
+                  const T _to = 0, const T _by = 0);
 
     /* Getters */
-    inline Identifier from() const { return m_from; }
-    inline Identifier to() const { return m_to; }
-    inline int by() const { return m_by; }
+    inline T from() const { return m_from; }
+    inline T to() const { return m_to; }
+    inline T by() const { return m_by; }
 
     /* Boolean Operations */
-    bool operator==(const Range &other) const;
-    bool operator!=(const Range &other) const;
+    bool operator==(const BasicRange<T> &other) const;
+    bool operator!=(const BasicRange<T> &other) const;
+
+    /* Set Operations */
+    bool contains(const T identifier) const;
+    BasicRange<T> intersected(const BasicRange<T> &other) const;
+    QList<BasicRange<T> > subtracted(const BasicRange<T> &other) const;
+    QList<BasicRange<T> > united(const BasicRange<T> &other) const;
 
 private:
-    Identifier m_from;
-    Identifier m_to;
-    int m_by;
+    T m_from;
+    T m_to;
+    T m_by;
     void simplify();
 
 };
 
+typedef BasicRange<Identifier> Range;
+typedef BasicRange<Identifier64> Range64;
+
+template <> Identifier BasicRange<Identifier>::maximum();
+template <> Identifier64 BasicRange<Identifier64>::maximum();
+
+/*
+ * Contiguous array of ranges. It's implicitly shared, so that the arrays
+ * computed by the kernels are handed to the range lists without copy.
+ */
+template <typename T>
+using BasicRangeArray = QVector<BasicRange<T> >;
+
+typedef BasicRangeArray<Identifier> RangeArray;
+typedef BasicRangeArray<Identifier64> RangeArray64;
+
+/*!
+ * \class BasicRangeSpan
+ * \brief The BasicRangeSpan class is a read-only view on contiguous ranges of type \a T.
+ *
+ * The span doesn't own the ranges, so copying it is free, but it must not
+ * outlive the array it views, nor be used after the array is modified.
+ *
+ * Use RangeSpan for 32-bit identifiers, and RangeSpan64 for 64-bit identifiers.
+ */
+template <typename T>
+class BasicRangeSpan
+{
+public:
+    typedef const BasicRange<T> *const_iterator;
+
+    inline BasicRangeSpan() : m_data(Q_NULLPTR), m_count(0) {}
+    inline BasicRangeSpan(const BasicRange<T> *data, const int count)
+        : m_data(data), m_count(count) {}
+    inline BasicRangeSpan(const BasicRangeArray<T> &ranges)
+        : m_data(ranges.constData()), m_count(ranges.count()) {}
+
+    inline int count() const { return m_count; }
+    inline bool isEmpty() const { return m_count == 0; }
+    inline const BasicRange<T> &at(const int i) const { return m_data[i]; }
+    inline const BasicRange<T> &operator[](const int i) const { return m_data[i]; }
+    inline const BasicRange<T> &first() const { return m_data[0]; }
+    inline const BasicRange<T> &last() const { return m_data[m_count - 1]; }
+
+    inline const_iterator begin() const { return m_data; }
+    inline const_iterator end() const { return m_data + m_count; }
+    inline const_iterator constBegin() const { return m_data; }
+    inline const_iterator constEnd() const { return m_data + m_count; }
+
+    inline BasicRangeSpan<T> mid(const int pos, const int length) const
+    { return BasicRangeSpan<T>(m_data + pos, length); }
+
+private:
+    const BasicRange<T> *m_data;
+    int m_count;
+};
+
+typedef BasicRangeSpan<Identifier> RangeSpan;
+typedef BasicRangeSpan<Identifier64> RangeSpan64;
+
+Q_DECLARE_TYPEINFO(Range, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(Range64, Q_MOVABLE_TYPE);
+
 #endif // RANGE_H
@@ -0,0 +1,452 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RANGE_P_H
+#define RANGE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public API. It contains the kernels shared by
+// Range and RangeList to compute set operations without expanding identifiers.
+//
+
+#include "range.h"
+
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+/*!
+ * \internal
+ * \brief Orders the ranges by their first identifier.
+ */
+template <typename T>
+static inline bool _q_lessThan(const BasicRange<T> &r1, const BasicRange<T> &r2)
+{
+    return r1.from() < r2.from();
+}
+
+/*!
+ * \internal
+ * \class RangePacker
+ * \brief The RangePacker class packs a sorted stream of identifiers into ranges.
+ *
+ * Identifiers must be pushed in strictly increasing order, either one by one or
+ * as whole progressions. The result is the same as _q_collapse(): the values are
+ * packed from the left, and only if at least 3 values are equally spaced.
+ *
+ * A progression that continues the current range is absorbed in constant time,
+ * thus the cost depends on the number of pushed progressions, not on the number
+ * of identifiers.
+ */
+template <typename T>
+class RangePacker
+{
+public:
+    explicit RangePacker(BasicRangeArray<T> *output)
+        : m_output(output)
+        , m_isRunning(false)
+        , m_begin(0), m_last(0), m_step(0)
+        , m_pendingCount(0)
+    {}
+
+    void push(const qint64 value)
+    {
+        if (m_isRunning) {
+            if (value == m_last + m_step) {
+                m_last = value;
+                return;
+            }
+            flushRun();
+            m_pending[0] = value;
+            m_pendingCount = 1;
+            return;
+        }
+        m_pending[m_pendingCount++] = value;
+        if (m_pendingCount == 3) {
+            if (m_pending[1] - m_pending[0] == m_pending[2] - m_pending[1]) {
+                m_isRunning = true;
+                m_begin = m_pending[0];
+                m_last = m_pending[2];
+                m_step = m_pending[2] - m_pending[1];
+                m_pendingCount = 0;
+            } else {
+                flushSingle(m_pending[0]);
+                m_pending[0] = m_pending[1];
+                m_pending[1] = m_pending[2];
+                m_pendingCount = 2;
+            }
+        }
+    }
+
+    void push(const qint64 from, const qint64 to, const qint64 by)
+    {
+        Q_ASSERT(by > 0);
+        for (qint64 value = from; value <= to; value += by) {
+            push(value);
+            if (m_isRunning && m_step == by && m_last == value) {
+                /* Fast-forward: the remaining values extend the current range. */
+                m_last = value + ((to - value) / by) * by;
+                return;
+            }
+        }
+    }
+
+    /* Returns true if the current range is exactly the given \a range, so far */
+    bool isRunning(const BasicRange<T> &range) const
+    {
+        return m_isRunning && m_begin == range.from() && m_last == range.to()
+                && m_step == range.by();
+    }
+
+    void finish()
+    {
+        if (m_isRunning) {
+            flushRun();
+        }
+        for (int i = 0; i < m_pendingCount; ++i) {
+            flushSingle(m_pending[i]);
+        }
+        m_pendingCount = 0;
+    }
+
+private:
+    BasicRangeArray<T> *m_output;
+    bool m_isRunning;
+    qint64 m_begin;
+    qint64 m_last;
+    qint64 m_step;
+    qint64 m_pending[3];
+    int m_pendingCount;
+
+    inline void flushRun()
+    {
+        m_output->append(BasicRange<T>(T(m_begin), T(m_last), T(m_step)));
+        m_isRunning = false;
+    }
+    inline void flushSingle(const qint64 value)
+    {
+        m_output->append(BasicRange<T>(T(value), T(value), 1));
+    }
+};
+
+/*!
+ * \internal
+ * \brief Progression being consumed by the sweeps, with 64-bit arithmetic
+ * so that 'next' never overflows past the last identifier.
+ * This holds for 64-bit identifiers too, since they are lower than 2^62.
+ */
+struct RangeCursor
+{
+    qint64 next;
+    qint64 to;
+    qint64 by;
+};
+
+typedef QVarLengthArray<RangeCursor, 8> RangeCursorArray;
+
+static inline qint64 _q_gcd(qint64 a, qint64 b)
+{
+    while (b != 0) {
+        const qint64 t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*!
+ * \internal
+ * \brief Pushes into the \a packer the identifiers of \a range that are
+ * between \a lo and \a hi.
+ */
+template <typename T>
+static inline void _q_push_between(const BasicRange<T> &range, const qint64 lo, const qint64 hi,
+                                   RangePacker<T> &packer)
+{
+    const qint64 from = range.from();
+    const qint64 by = range.by();
+    const qint64 first = (lo <= from) ? from : from + ((lo - from + by - 1) / by) * by;
+    const qint64 last = qMin(hi, qint64(range.to()));
+    if (first <= last) {
+        packer.push(first, last, by);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Returns the index of the first of the sorted \a values, from \a begin,
+ * that doesn't continue the progression of step \a by, i.e. such that
+ * values[i] - values[i-1] != by. Returns \a count if the progression goes to the end.
+ *
+ * The steps are compared by blocks of 8 or 4 identifiers with AVX2 or SSE2,
+ * when the compiler targets them (AVX2 needs CONFIG+=simd, see simd.pri),
+ * and one by one otherwise.
+ */
+static inline int _q_progressionEnd(const qint32 *values, int begin, const int count,
+                                    const qint32 by)
+{
+    Q_ASSERT(begin > 0);
+    int i = begin;
+#if defined(__AVX2__)
+    const __m256i steps = _mm256_set1_epi32(by);
+    for (; i + 8 <= count; i += 8) {
+        const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        const __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i - 1));
+        const __m256i eq = _mm256_cmpeq_epi32(_mm256_sub_epi32(cur, prev), steps);
+        const uint mask = uint(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+        if (mask != 0xFF)
+            return i + int(qCountTrailingZeroBits(~mask & 0xFF));
+    }
+#elif defined(__SSE2__)
+    const __m128i steps = _mm_set1_epi32(by);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        const __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i - 1));
+        const __m128i eq = _mm_cmpeq_epi32(_mm_sub_epi32(cur, prev), steps);
+        const uint mask = uint(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+        if (mask != 0xF)
+            return i + int(qCountTrailingZeroBits(~mask & 0xF));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (values[i] - values[i - 1] != by)
+            return i;
+    }
+    return count;
+}
+
+/*!
+ * \internal
+ * \overload
+ * The 64-bit steps are compared by blocks of 4 or 2 identifiers with AVX2
+ * or SSE4.1, i.e. when built with CONFIG+=simd, and one by one otherwise.
+ */
+static inline int _q_progressionEnd(const qint64 *values, int begin, const int count,
+                                    const qint64 by)
+{
+    Q_ASSERT(begin > 0);
+    int i = begin;
+#if defined(__AVX2__)
+    const __m256i steps = _mm256_set1_epi64x(by);
+    for (; i + 4 <= count; i += 4) {
+        const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        const __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i - 1));
+        const __m256i eq = _mm256_cmpeq_epi64(_mm256_sub_epi64(cur, prev), steps);
+        const uint mask = uint(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+        if (mask != 0xF)
+            return i + int(qCountTrailingZeroBits(~mask & 0xF));
+    }
+#elif defined(__SSE4_1__)
+    const __m128i steps = _mm_set1_epi64x(by);
+    for (; i + 2 <= count; i += 2) {
+        const __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        const __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i - 1));
+        const __m128i eq = _mm_cmpeq_epi64(_mm_sub_epi64(cur, prev), steps);
+        const uint mask = uint(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+        if (mask != 0x3)
+            return i + int(qCountTrailingZeroBits(~mask & 0x3));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (values[i] - values[i - 1] != by)
+            return i;
+    }
+    return count;
+}
+
+/*!
+ * \internal
+ * \brief Sorts the \a count \a values in place, with a LSD radix sort.
+ *
+ * The values must be positive. Each pass sorts one byte, from the lowest to the
+ * highest one, and stops at the highest byte of the greatest value. The passes
+ * where all the values have the same byte are skipped.
+ */
+template <typename T>
+static inline void _q_radixSort(T *values, const int count)
+{
+    if (count < 2)
+        return;
+
+    T max = 0;
+    for (int i = 0; i < count; ++i) {
+        max = qMax(max, values[i]);
+    }
+
+    QVector<T> buffer(count);
+    T *src = values;
+    T *dst = buffer.data();
+
+    for (int shift = 0; shift < int(8 * sizeof(T)) && (max >> shift) != 0; shift += 8) {
+        int offsets[256] = {};
+        for (int i = 0; i < count; ++i) {
+            offsets[(src[i] >> shift) & 0xFF]++;
+        }
+        if (offsets[(src[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+        int offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            const int digitCount = offsets[digit];
+            offsets[digit] = offset;
+            offset += digitCount;
+        }
+        for (int i = 0; i < count; ++i) {
+            dst[offsets[(src[i] >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != values) {
+        std::copy(src, src + count, values);
+    }
+}
+
+static inline void _q_setBit(quint64 *words, const int value)
+{
+    words[value >> 6] |= Q_UINT64_C(1) << (value & 63);
+}
+
+static inline void _q_clearBit(quint64 *words, const int value)
+{
+    words[value >> 6] &= ~(Q_UINT64_C(1) << (value & 63));
+}
+
+/*!
+ * \internal
+ * \brief Sets the bits from \a start to \a last, included.
+ */
+static inline void _q_setBits(quint64 *words, const int start, const int last)
+{
+    const int first = start >> 6;
+    const int end = last >> 6;
+    const quint64 head = ~Q_UINT64_C(0) << (start & 63);
+    const quint64 tail = ~Q_UINT64_C(0) >> (63 - (last & 63));
+    if (first == end) {
+        words[first] |= head & tail;
+        return;
+    }
+    words[first] |= head;
+    for (int i = first + 1; i < end; ++i) {
+        words[i] = ~Q_UINT64_C(0);
+    }
+    words[end] |= tail;
+}
+
+/*!
+ * \internal
+ * \brief Sets every \a by bits from \a start to \a last, included.
+ *
+ * For steps up to 64, each word is set at once, with the pattern of the
+ * step shifted to the first bit of the word.
+ */
+static inline void _q_setBitsStrided(quint64 *words, const int start, const int last,
+                                     const int by)
+{
+    if (by > 64) {
+        for (int value = start; value <= last; value += by) {
+            _q_setBit(words, value);
+        }
+        return;
+    }
+    quint64 pattern = 0;
+    for (int bit = 0; bit < 64; bit += by) {
+        pattern |= Q_UINT64_C(1) << bit;
+    }
+    const int end = last >> 6;
+    int offset = start & 63;
+    for (int i = start >> 6; i < end; ++i) {
+        words[i] |= pattern << offset;
+        offset = ((offset - 64) % by + by) % by;
+    }
+    words[end] |= (pattern << offset) & (~Q_UINT64_C(0) >> (63 - (last & 63)));
+}
+
+/*!
+ * \internal
+ * \brief Returns the first bit from \a pos that is set (or not set if \a isSet
+ * is false), or the number of bits of the \a wordCount words if there is none.
+ */
+static inline int _q_nextBit(const quint64 *words, const int wordCount, const int pos,
+                             const bool isSet)
+{
+    int i = pos >> 6;
+    quint64 w = (isSet ? words[i] : ~words[i]) & (~Q_UINT64_C(0) << (pos & 63));
+    while (w == 0) {
+        if (++i == wordCount)
+            return wordCount << 6;
+        w = isSet ? words[i] : ~words[i];
+    }
+    return (i << 6) + int(qCountTrailingZeroBits(w));
+}
+
+/*!
+ * \internal
+ * \brief Pushes into the \a packer the \a count sorted and duplicate-free \a values.
+ *
+ * The progressions are found with _q_progressionEnd(), that compares the
+ * steps of several identifiers at once, and each progression of at least
+ * 3 values is pushed at once.
+ */
+template <typename T>
+static inline void _q_pushSorted(const T *values, const int count, RangePacker<T> &packer)
+{
+    int i = 0;
+    while (i < count) {
+        if (i + 2 < count && values[i + 2] - values[i + 1] == values[i + 1] - values[i]) {
+            const T by = values[i + 1] - values[i];
+            const int next = _q_progressionEnd(values, i + 3, count, by);
+            packer.push(values[i], values[next - 1], by);
+            i = next;
+        } else {
+            packer.push(values[i]);
+            i++;
+        }
+    }
+}
+
+template <typename T>
+void _q_unite_window(RangeCursorArray &cursors,
+                     const qint64 pos, const qint64 end,
+                     RangePacker<T> &packer);
+
+template <typename T>
+bool _q_meet(const BasicRange<T> &r1, const BasicRange<T> &r2, const qint64 lo,
+             qint64 &first, qint64 &step);
+
+template <typename T>
+void _q_subtract_window(const BasicRange<T> &range, const BasicRange<T> &removed,
+                        const qint64 lo, const qint64 hi,
+                        RangePacker<T> &packer);
+
+#endif // RANGE_P_H
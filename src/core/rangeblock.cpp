@@ -0,0 +1,189 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rangeblock.h"
+
+/*!
+ * \class BasicRangeBlock
+ *
+ * Mesh generators often number the entities by blocks, like pairs of identifiers
+ * repeating every 10 identifiers:
+ *
+ * \code
+ *   // 95004122 95004123 95004132 95004133 95004142 95004143
+ *   RangeBlock block( Range(95004122, 95004123), 10, 3 );
+ * \endcode
+ *
+ * A single Range can't hold such patterns, so they would be stored as singletons.
+ *
+ * The runs must not overlap, i.e. the period must be greater than the span of
+ * the run. Otherwise, the block is empty.
+ */
+
+template <typename T>
+BasicRangeBlock<T>::BasicRangeBlock(const BasicRange<T> &_run,
+                                    const T _period, const T _repeat)
+    : m_run(_run)
+    , m_period(_period)
+    , m_repeat(_repeat)
+{
+    this->simplify();
+}
+
+/*!
+ * \brief Returns the number of identifiers in the block.
+ */
+template <typename T>
+T BasicRangeBlock<T>::count() const
+{
+    return m_run.count() * m_repeat;
+}
+
+template <typename T>
+bool BasicRangeBlock<T>::isEmpty() const
+{
+    return m_run.isEmpty();
+}
+
+template <typename T>
+void BasicRangeBlock<T>::clear()
+{
+    m_run.clear();
+    m_period = 0;
+    m_repeat = 0;
+}
+
+/*!
+ * \brief Returns the first identifier of the block.
+ */
+template <typename T>
+T BasicRangeBlock<T>::from() const
+{
+    return m_run.from();
+}
+
+/*!
+ * \brief Returns the last identifier of the block.
+ */
+template <typename T>
+T BasicRangeBlock<T>::to() const
+{
+    if (isEmpty())
+        return 0;
+    return m_run.to() + (m_repeat - 1) * m_period;
+}
+
+/*!
+ * \brief Returns the run at the given \a index, between 0 and repeat() - 1.
+ */
+template <typename T>
+BasicRange<T> BasicRangeBlock<T>::runAt(const T index) const
+{
+    if (index < 0 || index >= m_repeat)
+        return BasicRange<T>();
+    const T shift = index * m_period;
+    return BasicRange<T>(m_run.from() + shift, m_run.to() + shift, m_run.by());
+}
+
+/*!
+ * \brief Returns the runs of the block, sorted.
+ */
+template <typename T>
+QList<BasicRange<T> > BasicRangeBlock<T>::runs() const
+{
+    QList<BasicRange<T> > res;
+    if (isEmpty())
+        return res;
+    res.reserve(int(m_repeat));
+    for (T i = 0; i < m_repeat; ++i) {
+        res.append(runAt(i));
+    }
+    return res;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+bool BasicRangeBlock<T>::operator==(const BasicRangeBlock<T> &other) const
+{
+    return (*this).m_run == other.m_run
+            && (*this).m_period == other.m_period
+            && (*this).m_repeat == other.m_repeat;
+}
+
+template <typename T>
+bool BasicRangeBlock<T>::operator!=(const BasicRangeBlock<T> &other) const
+{
+    return ((*this) == other) ? false : true;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Returns true if the block contains the given \a identifier.
+ *
+ * The runs don't overlap, thus only one run can contain it.
+ */
+template <typename T>
+bool BasicRangeBlock<T>::contains(const T identifier) const
+{
+    if (isEmpty() || identifier < from() || identifier > to())
+        return false;
+    if (m_repeat == 1)
+        return m_run.contains(identifier);
+    const T index = qMin(T((identifier - m_run.from()) / m_period), T(m_repeat - 1));
+    return m_run.contains(identifier - index * m_period);
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+void BasicRangeBlock<T>::simplify()
+{
+    if (m_run.isEmpty() || m_repeat <= 0) {
+        clear();
+        return;
+    }
+
+    if (m_repeat == 1) { /* Makes it a single-run block */
+        m_period = 0;
+        return;
+    }
+
+    if (m_period <= qint64(m_run.to()) - m_run.from()) {
+        clear(); /* Overlapping runs */
+        return;
+    }
+
+    const qint64 room = qint64(BasicRange<T>::maximum()) - m_run.to();
+    if (room / m_period < qint64(m_repeat) - 1) {
+        clear(); /* Out of bounds */
+        return;
+    }
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template class BasicRangeBlock<Identifier>;
+template class BasicRangeBlock<Identifier64>;
@@ -0,0 +1,83 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RANGEBLOCK_H
+#define RANGEBLOCK_H
+
+#include "range.h"
+
+#include <QtCore/QList>
+
+/*!
+ * \class BasicRangeBlock
+ * \brief The BasicRangeBlock class is a progression of runs of identifiers of
+ * type \a T, i.e. a range of ranges.
+ *
+ * The block repeats its first run every \a period identifiers, \a repeat times.
+ *
+ * Use RangeBlock for 32-bit identifiers, and RangeBlock64 for 64-bit identifiers.
+ */
+template <typename T>
+class BasicRangeBlock
+{
+public:
+    explicit BasicRangeBlock(const BasicRange<T> &_run = BasicRange<T>(),
+                             const T _period = 0, const T _repeat = 1);
+
+    T count() const;
+    bool isEmpty() const;
+    void clear();
+
+    /* Getters */
+    inline BasicRange<T> run() const { return m_run; }
+    inline T period() const { return m_period; }
+    inline T repeat() const { return m_repeat; }
+
+    T from() const;
+    T to() const;
+    BasicRange<T> runAt(const T index) const;
+    QList<BasicRange<T> > runs() const;
+
+    /* Boolean Operations */
+    bool operator==(const BasicRangeBlock<T> &other) const;
+    bool operator!=(const BasicRangeBlock<T> &other) const;
+
+    /* Set Operations */
+    bool contains(const T identifier) const;
+
+private:
+    BasicRange<T> m_run;
+    T m_period;
+    T m_repeat;
+    void simplify();
+
+};
+
+typedef BasicRangeBlock<Identifier> RangeBlock;
+typedef BasicRangeBlock<Identifier64> RangeBlock64;
+
+Q_DECLARE_TYPEINFO(RangeBlock, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(RangeBlock64, Q_MOVABLE_TYPE);
+
+#endif // RANGEBLOCK_H
@@ -78,17 +78,15 @@ void RangeHelper::deleteInstance()
     }
 }
 
-/*!
- * \brief Converts a Range into packed string (=canonical form).
- */
-QString RangeHelper::toPackedString(const Range &range) const
+template <typename T>
+static inline QString _q_toPackedString(const BasicRange<T> &range)
 {
     if (range.isEmpty())
         return QString();
 
-    const Identifier from = range.from();
-    const Identifier to = range.to();
-    const int by = range.by();
+    const T from = range.from();
+    const T to = range.to();
+    const T by = range.by();
 
     if (from == to) {
         return QString("%0").arg(from);
@@ -101,23 +99,97 @@ QString RangeHelper::toPackedString(const Range &range) const
     return QString("%0:%1:%2").arg(from).arg(to).arg(by);
 }
 
-/*!
- * \brief Converts a Range into unpacked string (=expanded identifiers).
- */
-QStringList RangeHelper::toUnpackedStringList(const Range &range) const
+template <typename T>
+static inline QStringList _q_toUnpackedStringList(const BasicRange<T> &range)
 {
     QStringList res;
 
     if (range.isEmpty())
         return res;
 
-    const Identifier from = range.from();
-    const Identifier to = range.to();
-    const int by = range.by();
+    const qint64 from = range.from();
+    const qint64 to = range.to();
+    const qint64 by = range.by();
 
-    for (int i = from; i <= to; i += by) {
+    for (qint64 i = from; i <= to; i += by) {
         res.append(QString("%0").arg(i));
     }
 
     return res;
 }
+
+template <typename T>
+static inline QString _q_toPackedString(const BasicRangeBlock<T> &block)
+{
+    if (block.repeat() <= 1)
+        return _q_toPackedString(block.run());
+
+    const T lastFrom = block.runAt(block.repeat() - 1).from();
+    return QString("[%0]:%1:%2").arg(_q_toPackedString(block.run()))
+            .arg(lastFrom).arg(block.period());
+}
+
+template <typename T>
+static inline QStringList _q_toUnpackedStringList(const BasicRangeBlock<T> &block)
+{
+    QStringList res;
+    foreach (auto run, block.runs()) {
+        res.append(_q_toUnpackedStringList(run));
+    }
+    return res;
+}
+
+/*!
+ * \brief Converts a Range into packed string (=canonical form).
+ */
+QString RangeHelper::toPackedString(const Range &range) const
+{
+    return _q_toPackedString(range);
+}
+
+QString RangeHelper::toPackedString(const Range64 &range) const
+{
+    return _q_toPackedString(range);
+}
+
+/*!
+ * \brief Converts a Range into unpacked string (=expanded identifiers).
+ */
+QStringList RangeHelper::toUnpackedStringList(const Range &range) const
+{
+    return _q_toUnpackedStringList(range);
+}
+
+QStringList RangeHelper::toUnpackedStringList(const Range64 &range) const
+{
+    return _q_toUnpackedStringList(range);
+}
+
+/*!
+ * \brief Converts a RangeBlock into packed string.
+ *
+ * The block is written like a range of runs: "[122:123]:142:10" stands for
+ * the run 122:123, repeated every 10 identifiers up to the run starting at 142.
+ */
+QString RangeHelper::toPackedString(const RangeBlock &block) const
+{
+    return _q_toPackedString(block);
+}
+
+QString RangeHelper::toPackedString(const RangeBlock64 &block) const
+{
+    return _q_toPackedString(block);
+}
+
+/*!
+ * \brief Converts a RangeBlock into unpacked string (=expanded identifiers).
+ */
+QStringList RangeHelper::toUnpackedStringList(const RangeBlock &block) const
+{
+    return _q_toUnpackedStringList(block);
+}
+
+QStringList RangeHelper::toUnpackedStringList(const RangeBlock64 &block) const
+{
+    return _q_toUnpackedStringList(block);
+}
@@ -26,6 +26,7 @@
 #define RANGEHELPER_H
 
 #include "range.h"
+#include "rangeblock.h"
 
 class RangeHelper
 {    
@@ -45,6 +46,15 @@ public:
     QString toPackedString(const Range &range) const;
     QStringList toUnpackedStringList(const Range &range) const;
 
+    QString toPackedString(const Range64 &range) const;
+    QStringList toUnpackedStringList(const Range64 &range) const;
+
+    QString toPackedString(const RangeBlock &block) const;
+    QStringList toUnpackedStringList(const RangeBlock &block) const;
+
+    QString toPackedString(const RangeBlock64 &block) const;
+    QStringList toUnpackedStringList(const RangeBlock64 &block) const;
+
 };
 
 #endif // RANGEHELPER_H
@@ -23,128 +23,1199 @@
  */
 
 #include "rangelist.h"
+#include "range_p.h"
 
 #include <QtCore/QList>
 #include <QtCore/QDebug>
 #include <QtCore/QSet>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
 #include <algorithm>
+#include <functional>
+#include <iterator>
 
-RangeList::RangeList()
+/* Number of ranges per thread, below which the union is not split across threads. */
+static const int C_PARALLEL_GRAIN = 32768;
+
+/* Number of identifiers per thread, below which the collapse is not split across threads. */
+static const int C_PARALLEL_COLLAPSE_GRAIN = 1 << 20;
+
+/* Number of identifiers at both ends of a range, where the optimal packing can cut it. */
+static const int C_PACKING_EDGE = 32;
+
+/* Number of ranges added at once, up to which only the touched ranges are united again. */
+static const int C_SMALL_COUNT = 8;
+
+/* Number of identifiers, or of ranges, below which the dense path is not tried. */
+static const int C_DENSE_MIN_COUNT = 1024;
+
+/* Number of bits per identifier, or per range, above which the input is too sparse for a bitset. */
+static const int C_DENSE_BITS_PER_ITEM = 32;
+
+/* Maximum number of bits of a bitset, i.e. 32 MB. */
+static const qint64 C_DENSE_MAX_BITS = Q_INT64_C(1) << 28;
+
+template <typename T>
+static inline bool _q_toLessThan(const BasicRange<T> &range, const qint64 identifier)
+{
+    return range.to() < identifier;
+}
+
+template <typename T>
+static inline BasicRangeArray<T> _q_toSortedArray(const QList<BasicRange<T> > &ranges)
+{
+    BasicRangeArray<T> res;
+    res.reserve(ranges.count());
+    foreach (auto range, ranges) {
+        res.append(range);
+    }
+    std::sort(res.begin(), res.end(), _q_lessThan<T>);
+    return res;
+}
+
+/*!
+ * \internal
+ * \brief Returns the runs of the given \a block, sorted and without overlap.
+ */
+template <typename T>
+static inline QVarLengthArray<BasicRange<T>, C_SMALL_COUNT> _q_toRuns(const BasicRangeBlock<T> &block)
+{
+    QVarLengthArray<BasicRange<T>, C_SMALL_COUNT> runs;
+    for (T i = 0; i < block.repeat(); ++i) {
+        runs.append(block.runAt(i));
+    }
+    return runs;
+}
+
+/*!
+ * \internal
+ * \brief Pushes into the \a packer the union of the given \a sortedRanges,
+ * window by window.
+ */
+template <typename T>
+static void _q_sweep(const BasicRangeSpan<T> &sortedRanges, RangePacker<T> &packer)
+{
+    RangeCursorArray cursors;
+
+    const int count = sortedRanges.count();
+    int i = 0;
+    qint64 pos = 0;
+
+    while (true) {
+        /* Remove the exhausted cursors */
+        for (int j = cursors.count() - 1; j >= 0; --j) {
+            if (cursors.at(j).next > cursors.at(j).to) {
+                cursors.remove(j);
+            }
+        }
+
+        /* Skip empty ranges */
+        while (i < count && sortedRanges.at(i).isEmpty()) {
+            i++;
+        }
+
+        if (cursors.isEmpty()) {
+            if (i >= count)
+                break;
+            pos = sortedRanges.at(i).from();
+        }
+
+        while (i < count && sortedRanges.at(i).from() <= pos) {
+            const BasicRange<T> &range = sortedRanges.at(i);
+            if (!range.isEmpty()) {
+                RangeCursor c;
+                c.next = range.from();
+                c.to = range.to();
+                c.by = range.by();
+                cursors.append(c);
+            }
+            i++;
+        }
+
+        /* The window ends where a range ends, or just before a range starts */
+        qint64 end = cursors.first().to;
+        for (int j = 1; j < cursors.count(); ++j) {
+            end = qMin(end, cursors.at(j).to);
+        }
+        if (i < count) {
+            end = qMin(end, qint64(sortedRanges.at(i).from()) - 1);
+        }
+
+        _q_unite_window(cursors, pos, end, packer);
+        pos = end + 1;
+    }
+}
+
+/*!
+ * \internal
+ * \class RangeFunctionTask
+ * \brief The RangeFunctionTask class calls a function of a part index, in a worker
+ * thread, then releases the \a done semaphore.
+ */
+class RangeFunctionTask : public QRunnable
+{
+public:
+    explicit RangeFunctionTask(const std::function<void(int)> &function, const int part,
+                               QSemaphore *done)
+        : m_function(function), m_part(part), m_done(done)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        m_function(m_part);
+        m_done->release();
+    }
+
+private:
+    const std::function<void(int)> m_function;
+    const int m_part;
+    QSemaphore *m_done;
+};
+
+/*!
+ * \internal
+ * \brief Returns the pool of the parallel kernels.
+ *
+ * The pool is created once, so that its threads are reused from a call to
+ * the next one. It's not the global pool, so that the kernels neither wait
+ * for the tasks of the application, nor are delayed by them.
+ */
+static QThreadPool *_q_threadPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
+/*!
+ * \internal
+ * \brief Calls \a function for each part index from 0 to \a parts - 1, on several
+ * threads, and returns when all the calls are finished.
+ *
+ * Only the calls of this function are waited for, so it can be called from
+ * several threads at once.
+ */
+static void _q_runParallel(const int parts, const std::function<void(int)> &function)
+{
+    QSemaphore done;
+    for (int p = 0; p < parts; ++p) {
+        _q_threadPool()->start(new RangeFunctionTask(function, p, &done));
+    }
+    done.acquire(parts);
+}
+
+/*!
+ * \internal
+ * \brief Returns the canonical ranges of the concatenated \a parts.
+ *
+ * The parts must be canonical, and each part must only hold identifiers greater
+ * than the ones of the previous parts. They are packed again, because a canonical
+ * range can span several parts.
+ */
+template <typename T>
+static BasicRangeArray<T> _q_stitch(const QVector<BasicRangeArray<T> > &parts)
+{
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
+    for (int p = 0; p < parts.count(); ++p) {
+        const BasicRangeArray<T> &part = parts.at(p);
+        for (int i = 0; i < part.count(); ++i) {
+            const BasicRange<T> &range = part.at(i);
+            packer.push(range.from(), range.to(), range.by());
+        }
+    }
+    packer.finish();
+    return res;
+}
+
+/***********************************************************************************
+ * DENSE PATH
+ ***********************************************************************************/
+/*!
+ * \internal
+ * \brief Returns true if the \a itemCount identifiers, or ranges, in [\a lo, \a hi]
+ * are dense enough to be handled as a bitset over [\a lo, \a hi].
+ *
+ * Then setting the bits and scanning the words is cheaper than sorting the
+ * identifiers, or sweeping the ranges.
+ */
+static inline bool _q_isDense(const qint64 lo, const qint64 hi, const qint64 itemCount)
+{
+    const qint64 span = hi - lo + 1;
+    return itemCount >= C_DENSE_MIN_COUNT
+            && span > 0
+            && span <= C_DENSE_MAX_BITS
+            && span <= C_DENSE_BITS_PER_ITEM * itemCount;
+}
+
+/*!
+ * \internal
+ * \brief Returns the bitset of the identifiers of \a ranges that are in [\a lo, \a hi].
+ * The bit i stands for the identifier lo + i.
+ *
+ * The continuous ranges are set word by word.
+ */
+template <typename T>
+static QVector<quint64> _q_toBits(const BasicRangeSpan<T> &ranges, const qint64 lo, const qint64 hi)
+{
+    QVector<quint64> words(int((hi - lo) / 64 + 1), 0);
+    quint64 *data = words.data();
+    for (int i = 0; i < ranges.count(); ++i) {
+        const BasicRange<T> &range = ranges.at(i);
+        if (range.isEmpty() || range.to() < lo || range.from() > hi)
+            continue;
+        const qint64 from = range.from();
+        const qint64 by = range.by();
+        const qint64 first = (lo <= from) ? from : from + ((lo - from + by - 1) / by) * by;
+        const qint64 last = qMin(hi, qint64(range.to()));
+        if (first > last)
+            continue;
+        if (by == 1) {
+            _q_setBits(data, int(first - lo), int(last - lo));
+        } else {
+            for (qint64 value = first; value <= last; value += by) {
+                _q_setBit(data, int(value - lo));
+            }
+        }
+    }
+    return words;
+}
+
+/*!
+ * \internal
+ * \brief Returns the canonical ranges of the bitset \a words, whose bit i stands
+ * for the identifier \a lo + i.
+ *
+ * The runs of set bits are found with qCountTrailingZeroBits(), so that
+ * the full and the empty words are skipped at once.
+ */
+template <typename T>
+static BasicRangeArray<T> _q_fromBits(const QVector<quint64> &words, const qint64 lo)
+{
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
+    const quint64 *data = words.constData();
+    const int wordCount = words.count();
+    const int end = wordCount << 6;
+    int pos = _q_nextBit(data, wordCount, 0, true);
+    while (pos < end) {
+        const int next = _q_nextBit(data, wordCount, pos, false);
+        packer.push(lo + pos, lo + next - 1, 1);
+        pos = (next < end) ? _q_nextBit(data, wordCount, next, true) : end;
+    }
+    packer.finish();
+    return res;
+}
+
+/*!
+ * \internal
+ * \brief Returns the canonical ranges of the identifiers in [\a lo, \a hi]
+ * of \a ranges1 and \a ranges2, combined word by word with \a combine.
+ */
+template <typename T, typename Combine>
+static BasicRangeArray<T> _q_combineBits(const BasicRangeSpan<T> &ranges1,
+                                         const BasicRangeSpan<T> &ranges2,
+                                         const qint64 lo, const qint64 hi,
+                                         Combine combine)
+{
+    QVector<quint64> words = _q_toBits(ranges1, lo, hi);
+    const QVector<quint64> other = _q_toBits(ranges2, lo, hi);
+    quint64 *data = words.data();
+    const quint64 *otherData = other.constData();
+    for (int i = 0; i < words.count(); ++i) {
+        data[i] = combine(data[i], otherData[i]);
+    }
+    return _q_fromBits<T>(words, lo);
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+BasicRangeList<T>::BasicRangeList()
+    : d(sharedNull())
+{
+}
+
+/*!
+ * \internal
+ * \brief Returns the data shared by all the empty range lists, so that
+ * constructing or clearing a range list doesn't allocate.
+ */
+template <typename T>
+BasicRangeListData<T> *BasicRangeList<T>::sharedNull()
+{
+    /* Never deleted: it holds one more reference than the range lists using it */
+    static BasicRangeListData<T> *const shared = []() {
+        BasicRangeListData<T> *data = new BasicRangeListData<T>();
+        data->ref.ref();
+        return data;
+    }();
+    return shared;
+}
+
+/*!
+ * \brief Clear the range list.
+ */
+template <typename T>
+void BasicRangeList<T>::clear()
+{
+    d = sharedNull();
+}
+
+/*!
+ * \brief Returns the number of unique identifiers in the RangeList.
+ */
+template <typename T>
+T BasicRangeList<T>::count() const
+{
+    return d->prefixCounts.last();
+}
+
+/*!
+ * \brief [FOR UNIT TEST ONLY] Returns the number of the ranges.
+ *
+ * \code
+ *   // assuming RangeList ranges = { "1:5:1", "8", "9" }
+ *   ranges.count();       // returns 7 (contains 7 identifiers: 1,2,3,4,5,8,9)
+ *   ranges.countRanges(); // returns 3 (contains 3 ranges)
+ * \endcode
+ *
+ */
+template <typename T>
+int BasicRangeList<T>::countRanges() const
+{
+    return d->canonicalRanges.count();
+}
+
+/*!
+ * \brief Returns a copy of the packed (canonical) ranges stored in this range list.
+ * \sa canonicalRanges()
+ */
+template <typename T>
+QList<BasicRange<T> > BasicRangeList<T>::ranges() const
+{
+    QList<BasicRange<T> > res;
+    res.reserve(d->canonicalRanges.count());
+    for (const BasicRange<T> &range : view()) {
+        res.append(range);
+    }
+    return res;
+}
+
+/*!
+ * \brief Returns the packed (canonical) ranges stored in this range list.
+ *
+ * Unlike ranges(), this doesn't copy anything: the ranges are stored contiguously,
+ * so prefer this method to walk large range lists.
+ */
+template <typename T>
+const BasicRangeArray<T> &BasicRangeList<T>::canonicalRanges() const
+{
+    return d->canonicalRanges;
+}
+
+/*!
+ * \brief Returns a read-only view on the packed (canonical) ranges.
+ *
+ * The view is a pointer and a count, so walking or copying it never touches the
+ * shared array: Q_FOREACH on canonicalRanges() takes a shallow copy, i.e. an atomic
+ * ref and deref, and a range-based for loop on a non-const copy of the array may
+ * detach it, i.e. copy all the ranges.
+ * The view is invalidated by any modification of the range list.
+ */
+template <typename T>
+BasicRangeSpan<T> BasicRangeList<T>::view() const
+{
+    return BasicRangeSpan<T>(d->canonicalRanges);
+}
+
+/*!
+ * \brief Returns the cost model that minimizes the number of ranges.
+ */
+PackingCost PackingCost::rangeCount()
+{
+    PackingCost cost;
+    cost.single = 1;
+    cost.range = 1;
+    cost.strided = 1;
+    cost.digit = 0;
+    return cost;
+}
+
+/*!
+ * \brief Returns the cost model that minimizes the number of characters
+ * of the Patran text, like "5 10:20 30:50:5".
+ */
+PackingCost PackingCost::patranText()
+{
+    PackingCost cost;
+    cost.single = 1;  // separator
+    cost.range = 2;   // separator and colon
+    cost.strided = 3; // separator and colons
+    cost.digit = 1;
+    return cost;
+}
+
+/*!
+ * \brief Returns the cost model that minimizes the number of fields of the
+ * Nastran SET cards, like "5,10,THRU,20,30,THRU,50,BY,5", hence the number of cards.
+ */
+PackingCost PackingCost::nastranFields()
+{
+    PackingCost cost;
+    cost.single = 1;
+    cost.range = 3;
+    cost.strided = 5;
+    cost.digit = 0;
+    return cost;
+}
+
+static inline int _q_digits(qint64 value)
+{
+    int digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+/*!
+ * \brief Returns the sorted ranges, without duplicate identifiers,
+ * that minimize the given packing \a cost.
+ *
+ * Unlike canonicalRanges(), that packs greedily from the left, this finds the
+ * optimal cut of the sorted identifiers in progressions, with a dynamic programming
+ * in linear time. As for canonicalRanges(), a range holds at least 3 identifiers.
+ *
+ * Example, minimizing the characters:
+ *    {10, 15, 20, 21, 22} -> {"10" "15" "20:22"}, instead of {"10:20:5" "21" "22"}
+ *
+ * \remark Cutting a long progression only adds costs, thus only the identifiers
+ * near the ends of the canonical ranges are cut points, and the
+ * identifiers deep inside are never expanded.
+ */
+template <typename T>
+QList<BasicRange<T> > BasicRangeList<T>::optimalRanges(const PackingCost &cost) const
+{
+    /* Cut points: the identifiers, except deep inside the long ranges,
+     * where only the first and last identifiers are kept, glued together. */
+    QVector<qint64> values;
+    QVector<qint64> steps;
+    QVector<bool> glued;
+    for (const BasicRange<T> &range : view()) {
+        const qint64 from = range.from();
+        const qint64 by = range.by();
+        const qint64 count = range.count();
+        for (qint64 k = 0; k < count; ++k) {
+            if (k == C_PACKING_EDGE + 1 && count > 2 * C_PACKING_EDGE + 2) {
+                k = count - C_PACKING_EDGE - 2;
+                values << from + k * by;
+                steps << by;
+                glued << true;
+                continue;
+            }
+            const qint64 value = from + k * by;
+            steps << (values.isEmpty() ? 0 : value - values.last());
+            values << value;
+            glued << false;
+        }
+    }
+
+    /* best[k] is the cost of the k first cut points, or -1 if k can't be a cut */
+    const int count = values.count();
+    QVector<qint64> best(count + 1, -1);
+    QVector<int> starts(count + 1, 0);
+    best[0] = 0;
+
+    int runBegin = 0;    // first cut point of the current progression
+    int candidate = 0;   // next cut point to consider as start of a range
+    qint64 bestStartCost = -1;
+    int bestStart = 0;
+
+    for (int j = 0; j < count; ++j) {
+        const qint64 value = values.at(j);
+        const qint64 by = steps.at(j);
+
+        if (j == 0 || by != steps.at(j - 1)) {
+            runBegin = qMax(0, j - 1);
+            candidate = runBegin;
+            bestStartCost = -1;
+        }
+        /* A range holds at least 3 identifiers */
+        while (j > 0 && candidate < j && values.at(candidate) <= value - 2 * by) {
+            if (!glued.at(candidate) && best.at(candidate) >= 0) {
+                const qint64 startCost = best.at(candidate) + cost.digit * _q_digits(values.at(candidate));
+                if (bestStartCost < 0 || startCost < bestStartCost) {
+                    bestStartCost = startCost;
+                    bestStart = candidate;
+                }
+            }
+            candidate++;
+        }
+
+        if (j + 1 < count && glued.at(j + 1))
+            continue; // cannot cut between glued identifiers
+
+        const qint64 digitCost = cost.digit * _q_digits(value);
+        if (!glued.at(j) && best.at(j) >= 0) {
+            best[j + 1] = best.at(j) + cost.single + digitCost;
+            starts[j + 1] = j;
+        }
+        if (bestStartCost >= 0) {
+            const qint64 rangeCost = bestStartCost + digitCost
+                    + (by == 1 ? cost.range : cost.strided + cost.digit * _q_digits(by));
+            if (best.at(j + 1) < 0 || rangeCost < best.at(j + 1)) {
+                best[j + 1] = rangeCost;
+                starts[j + 1] = bestStart;
+            }
+        }
+    }
+
+    QVector<int> cuts;
+    for (int k = count; k > 0; k = starts.at(k)) {
+        cuts << k;
+    }
+
+    QList<BasicRange<T> > res;
+    res.reserve(cuts.count());
+    for (int i = cuts.count() - 1; i >= 0; --i) {
+        const int end = cuts.at(i);
+        const int start = starts.at(end);
+        const qint64 by = (start == end - 1) ? 1 : steps.at(end - 1);
+        res << BasicRange<T>(T(values.at(start)), T(values.at(end - 1)), T(by));
+    }
+    return res;
+}
+
+
+/*!
+ * \internal
+ * \brief Returns the unit of the block detection at \a index: the range itself
+ * for a \a width of 1, or the pair of single identifiers for a \a width of 2.
+ * Returns an empty range if there is no such unit.
+ */
+template <typename T>
+static inline BasicRange<T> _q_unitAt(const BasicRangeArray<T> &ranges, const int index,
+                                      const int width)
+{
+    if (index + width > ranges.count())
+        return BasicRange<T>();
+    const BasicRange<T> &range = ranges.at(index);
+    if (width == 1)
+        return range.count() > 1 ? range : BasicRange<T>();
+
+    const BasicRange<T> &next = ranges.at(index + 1);
+    if (range.count() != 1 || next.count() != 1)
+        return BasicRange<T>();
+    return BasicRange<T>(range.from(), next.from(), next.from() - range.from());
+}
+
+/*!
+ * \brief Returns the identifiers as blocks, i.e. as progressions of runs.
+ *
+ * The canonical ranges that repeat with a constant period, and the pairs of
+ * single identifiers that repeat with a constant period, are packed in one block.
+ * The other canonical ranges are returned as blocks of one run.
+ *
+ * Example:
+ *    {"122" "123" "132" "133" "142" "143" "200:300"} -> {"[122:123]:142:10" "200:300"}
+ *
+ * \sa add(), remove()
+ */
+template <typename T>
+QList<BasicRangeBlock<T> > BasicRangeList<T>::blocks() const
+{
+    QList<BasicRangeBlock<T> > res;
+    const int count = d->canonicalRanges.count();
+    int i = 0;
+    while (i < count) {
+        BasicRangeBlock<T> best(d->canonicalRanges.at(i));
+        int bestEnd = i + 1;
+
+        for (int width = 1; width <= 2; ++width) {
+            const BasicRange<T> unit = _q_unitAt(d->canonicalRanges, i, width);
+            if (unit.isEmpty())
+                continue;
+
+            const BasicRange<T> second = _q_unitAt(d->canonicalRanges, i + width, width);
+            if (second.isEmpty() || second.count() != unit.count() || second.by() != unit.by())
+                continue;
+
+            const T period = second.from() - unit.from();
+            T repeat = 2;
+            int end = i + 2 * width;
+            while (true) {
+                const BasicRange<T> other = _q_unitAt(d->canonicalRanges, end, width);
+                if (other.isEmpty() || other.count() != unit.count() || other.by() != unit.by()
+                        || qint64(other.from()) - unit.from() != qint64(repeat) * period) {
+                    break;
+                }
+                repeat++;
+                end += width;
+            }
+            if (end > bestEnd) {
+                best = BasicRangeBlock<T>(unit, period, repeat);
+                bestEnd = end;
+            }
+        }
+        res << best;
+        i = bestEnd;
+    }
+    return res;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Returns true if the RangeList contains the given \a identifier.
+ * The search is done in O(log n), n being the number of ranges.
+ */
+template <typename T>
+bool BasicRangeList<T>::contains(const T identifier) const
+{
+    const typename BasicRangeArray<T>::const_iterator it =
+            std::lower_bound(d->canonicalRanges.constBegin(), d->canonicalRanges.constEnd(),
+                             identifier, _q_toLessThan<T>);
+    return it != d->canonicalRanges.constEnd() && it->contains(identifier);
+}
+
+/*!
+ * \brief Returns the number of identifiers lower than the given \a identifier.
+ * If the RangeList contains the \a identifier, this is its position.
+ *
+ * \code
+ *   // assuming RangeList ranges = { "10:14", "20:30:5" }
+ *   ranges.rank(12); // returns 2
+ *   ranges.rank(25); // returns 6
+ *   ranges.rank(99); // returns 8
+ * \endcode
+ *
+ * \sa select()
+ */
+template <typename T>
+T BasicRangeList<T>::rank(const T identifier) const
+{
+    return T(_q_rank(identifier));
+}
+
+/*!
+ * \brief Returns the identifier at the given \a index, i.e. the (index+1)-th
+ * smallest identifier. Returns 0 if the index is out of range.
+ *
+ * \code
+ *   // assuming RangeList ranges = { "10:14", "20:30:5" }
+ *   ranges.select(2); // returns 12
+ *   ranges.select(6); // returns 25
+ *   ranges.select(8); // returns 0
+ * \endcode
+ *
+ * \sa rank()
+ */
+template <typename T>
+T BasicRangeList<T>::select(const T index) const
+{
+    if (index < 0 || index >= d->prefixCounts.last())
+        return 0;
+
+    /* Last range whose prefix count is lower or equal to index */
+    const typename QVector<T>::const_iterator it =
+            std::upper_bound(d->prefixCounts.constBegin(), d->prefixCounts.constEnd(), index);
+    const int i = int(it - d->prefixCounts.constBegin()) - 1;
+    const BasicRange<T> &range = d->canonicalRanges.at(i);
+    return range.from() + (index - d->prefixCounts.at(i)) * range.by();
+}
+
+/*!
+ * \brief Returns the number of identifiers between \a from and \a to, inclusive.
+ */
+template <typename T>
+T BasicRangeList<T>::countInInterval(const T from, const T to) const
+{
+    if (from > to)
+        return 0;
+    const qint64 last = qMin(qint64(to), qint64(BasicRange<T>::maximum()));
+    return T(_q_rank(last + 1) - _q_rank(from));
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+void BasicRangeList<T>::add(const QSharedPointer<BasicRangeList<T> > other)
+{
+    this->_q_add(other->canonicalRanges());
+}
+
+template <typename T>
+void BasicRangeList<T>::add(const BasicRangeList<T> &other)
+{
+    this->_q_add(other.view());
+}
+
+/*!
+ * \brief Adds the identifiers of the temporary \a other range list, and clears it.
+ *
+ * If this range list is empty, it shares the data of \a other,
+ * without copying nor uniting the canonical ranges again.
+ */
+template <typename T>
+void BasicRangeList<T>::add(BasicRangeList<T> &&other)
+{
+    if (&other == this)
+        return;
+
+    if (view().isEmpty()) {
+        d = other.d;
+    } else {
+        this->_q_add(other.view());
+    }
+    other.clear();
+}
+
+/*!
+ * \brief Adds the given \a canonicalRanges, e.g. a view() on another range list,
+ * or a part of it.
+ *
+ * The ranges must be sorted by their first identifier.
+ */
+template <typename T>
+void BasicRangeList<T>::add(const BasicRangeSpan<T> &canonicalRanges)
 {
+    this->_q_add(canonicalRanges);
+}
+
+template <typename T>
+void BasicRangeList<T>::add(const BasicRange<T> &range)
+{
+    if (range.isEmpty())
+        return;
+
+    this->_q_add(BasicRangeSpan<T>(&range, 1));
 }
 
 /*!
- * \brief Clear the range list.
+ * \brief Adds the identifiers of the given \a block.
  */
-void RangeList::clear()
+template <typename T>
+void BasicRangeList<T>::add(const BasicRangeBlock<T> &block)
+{
+    if (block.isEmpty())
+        return;
+
+    const QVarLengthArray<BasicRange<T>, C_SMALL_COUNT> runs = _q_toRuns(block);
+    this->_q_add(BasicRangeSpan<T>(runs.constData(), runs.count()));
+}
+
+template <typename T>
+void BasicRangeList<T>::add(const QList<BasicRange<T> > &ranges)
 {
-    m_canonicalRanges.clear();
+    if (ranges.isEmpty())
+        return;
+
+    this->_q_add(_q_toSortedArray(ranges));
 }
 
 /*!
- * \brief Returns the number of unique identifiers in the RangeList.
+ * \internal
+ * \brief Next range of one of the lists, in the k-way merge.
  */
-int RangeList::count() const
+struct RangeListHead
 {
-    int count = 0;
-    foreach (auto item, m_canonicalRanges) {
-        count += item.count();
-    }
-    return count;
+    qint64 from;
+    int list;
+    int index;
+};
+
+/* Reversed order, for a min-heap */
+static inline bool _q_headGreaterThan(const RangeListHead &h1, const RangeListHead &h2)
+{
+    return h1.from > h2.from || (h1.from == h2.from && h1.list > h2.list);
 }
 
 /*!
- * \brief [FOR UNIT TEST ONLY] Returns the number of the ranges.
+ * \brief Adds the identifiers of all the \a others range lists.
+ *
+ * Unlike calling add() for each list, the canonical ranges of all the lists
+ * are merged in one k-way sweep, then united once. Thus the cost is
+ * O(n log k) for n ranges in k lists, instead of growing quadratically with k.
+ *
+ * Large inputs are split by identifier interval, and united on several threads.
  *
  * \code
- *   // assuming RangeList ranges = { "1:5:1", "8", "9" }
- *   ranges.count();       // returns 7 (contains 7 identifiers: 1,2,3,4,5,8,9)
- *   ranges.countRanges(); // returns 3 (contains 3 ranges)
+ *   QList<RangeListPtr> groups = ...; // thousands of SET cards
+ *   RangeList result;
+ *   result.add( groups );
  * \endcode
+ */
+template <typename T>
+void BasicRangeList<T>::add(const QList<QSharedPointer<BasicRangeList<T> > > &others)
+{
+    QVector<BasicRangeSpan<T> > lists;
+    lists.reserve(others.count() + 1);
+    int total = 0;
+    if (!view().isEmpty()) {
+        lists.append(view());
+        total += view().count();
+    }
+    foreach (auto other, others) {
+        if (other && !other->view().isEmpty()) {
+            lists.append(other->view());
+            total += other->view().count();
+        }
+    }
+    if (total == view().count())
+        return;
+
+    /* K-way merge of the sorted lists, with a min-heap of their heads */
+    QVector<RangeListHead> heap;
+    heap.reserve(lists.count());
+    for (int k = 0; k < lists.count(); ++k) {
+        RangeListHead head;
+        head.from = lists.at(k).first().from();
+        head.list = k;
+        head.index = 0;
+        heap.append(head);
+    }
+    std::make_heap(heap.begin(), heap.end(), _q_headGreaterThan);
+
+    BasicRangeArray<T> merged;
+    merged.reserve(total);
+    while (!heap.isEmpty()) {
+        std::pop_heap(heap.begin(), heap.end(), _q_headGreaterThan);
+        RangeListHead &head = heap.last();
+        const BasicRangeSpan<T> &list = lists.at(head.list);
+        merged.append(list.at(head.index));
+        if (++head.index < list.count()) {
+            head.from = list.at(head.index).from();
+            std::push_heap(heap.begin(), heap.end(), _q_headGreaterThan);
+        } else {
+            heap.removeLast();
+        }
+    }
+
+    setCanonicalRanges(_q_uniteParallel(merged));
+}
+
+/*!
+ * \brief Adds the given \a identifiers.
  *
+ * The identifiers can be unsorted and contain duplicates.
+ * They are sorted with a radix sort, so this is the fastest way to add
+ * a long list of unpacked identifiers.
  */
-int RangeList::countRanges() const
+template <typename T>
+void BasicRangeList<T>::add(const QVector<T> &identifiers)
 {
-    return m_canonicalRanges.count();
+    if (identifiers.isEmpty())
+        return;
+
+    QVector<T> values = identifiers;
+    this->_q_add(_q_collapseUnsorted(values));
 }
 
 /*!
- * \brief Returns the packed (canonical) ranges stored in this range list.
+ * \internal
+ * \brief Adds the \a sortedRanges.
+ *
+ * When only a few ranges are added to a non-empty list, the ranges they touch
+ * are united again, and the others are copied as is. See _q_addSmall().
  */
-QList<Range> RangeList::ranges() const
+template <typename T>
+void BasicRangeList<T>::_q_add(const BasicRangeSpan<T> &sortedRanges)
 {
-    return m_canonicalRanges;
+    if (sortedRanges.isEmpty())
+        return;
+
+    if (sortedRanges.count() <= C_SMALL_COUNT && !view().isEmpty()) {
+        this->_q_addSmall(sortedRanges);
+        return;
+    }
+
+    BasicRangeArray<T> merged;
+    merged.reserve(view().count() + sortedRanges.count());
+    std::merge(view().constBegin(), view().constEnd(),
+               sortedRanges.constBegin(), sortedRanges.constEnd(),
+               std::back_inserter(merged), _q_lessThan<T>);
+
+    setCanonicalRanges(_q_unite(merged));
 }
 
+/*!
+ * \internal
+ * \brief Adds a few \a sortedRanges, without merging them with all the
+ * canonical ranges and uniting the whole list again.
+ *
+ * The canonical ranges are packed greedily from the left, so the ranges that
+ * end more than two ranges before the added ones are kept. The touched ranges
+ * and the added ones are united in a small window. Then the next ranges are
+ * packed again, until the packer builds a range exactly as it was: from there,
+ * the packing can't change anymore, and the remaining ranges are copied.
+ */
+template <typename T>
+void BasicRangeList<T>::_q_addSmall(const BasicRangeSpan<T> &sortedRanges)
+{
+    /* Identifiers are strictly positive, so hi stays 0 if all the ranges are empty */
+    qint64 lo = 0;
+    qint64 hi = 0;
+    for (const BasicRange<T> &range : sortedRanges) {
+        if (!range.isEmpty()) {
+            if (hi == 0)
+                lo = range.from();
+            hi = qMax(hi, qint64(range.to()));
+        }
+    }
+    if (hi == 0)
+        return;
+
+    const BasicRangeSpan<T> ranges = view();
+    const int count = ranges.count();
+    const int touched = int(std::lower_bound(ranges.constBegin(), ranges.constEnd(),
+                                             lo, _q_toLessThan<T>) - ranges.constBegin());
+    const int begin = qMax(0, touched - 2);
+    const int end = int(std::upper_bound(ranges.constBegin() + touched, ranges.constEnd(),
+                                         BasicRange<T>(T(hi)), _q_lessThan<T>) - ranges.constBegin());
+
+    QVarLengthArray<BasicRange<T>, 2 * C_SMALL_COUNT> window;
+    window.resize(end - begin + sortedRanges.count());
+    std::merge(ranges.constBegin() + begin, ranges.constBegin() + end,
+               sortedRanges.constBegin(), sortedRanges.constEnd(),
+               window.begin(), _q_lessThan<T>);
+
+    BasicRangeArray<T> res;
+    res.reserve(count + sortedRanges.count());
+    for (int i = 0; i < begin; ++i) {
+        res.append(ranges.at(i));
+    }
+    RangePacker<T> packer(&res);
+    _q_sweep(BasicRangeSpan<T>(window.constData(), window.count()), packer);
+
+    int i = end;
+    while (i < count && (i == 0 || !packer.isRunning(ranges.at(i - 1)))) {
+        const BasicRange<T> &range = ranges.at(i);
+        packer.push(range.from(), range.to(), range.by());
+        i++;
+    }
+    packer.finish();
+    for (; i < count; ++i) {
+        res.append(ranges.at(i));
+    }
+    setCanonicalRanges(std::move(res));
+}
 
 /***********************************************************************************
  ***********************************************************************************/
-void RangeList::add(const RangeListPtr other)
+template <typename T>
+void BasicRangeList<T>::remove(const QSharedPointer<BasicRangeList<T> > other)
 {
-    this->add(other->ranges());
+    if (view().isEmpty())
+        return;
+
+    setCanonicalRanges(_q_subtract(view(), other->canonicalRanges()));
 }
 
-void RangeList::add(const Range &range)
+template <typename T>
+void BasicRangeList<T>::remove(const BasicRangeList<T> &other)
 {
-    QList<Range> ranges;
-    ranges << range;
-    this->add( ranges );
+    if (view().isEmpty())
+        return;
+
+    setCanonicalRanges(_q_subtract(view(), other.view()));
 }
 
-void RangeList::add(const QList<Range> &ranges)
+/*!
+ * \brief Removes the given \a canonicalRanges, e.g. a view() on another range list,
+ * or a part of it.
+ */
+template <typename T>
+void BasicRangeList<T>::remove(const BasicRangeSpan<T> &canonicalRanges)
 {
-    if (ranges.isEmpty())
+    if (view().isEmpty() || canonicalRanges.isEmpty())
+        return;
+
+    setCanonicalRanges(_q_subtract(view(), canonicalRanges));
+}
+
+template <typename T>
+void BasicRangeList<T>::remove(const BasicRange<T> &range)
+{
+    if (range.isEmpty() || view().isEmpty())
         return;
 
-    QSet<int> currentSet = _q_expand( m_canonicalRanges );
-    QSet<int> addedSet = _q_expand( ranges );
+    setCanonicalRanges(_q_subtract(view(), BasicRangeSpan<T>(&range, 1)));
+}
+
+/*!
+ * \brief Removes the identifiers of the given \a block.
+ */
+template <typename T>
+void BasicRangeList<T>::remove(const BasicRangeBlock<T> &block)
+{
+    if (block.isEmpty() || view().isEmpty())
+        return;
 
-    currentSet += addedSet;
+    /* The runs of a block are sorted and don't overlap */
+    const QVarLengthArray<BasicRange<T>, C_SMALL_COUNT> runs = _q_toRuns(block);
+    setCanonicalRanges(_q_subtract(view(), BasicRangeSpan<T>(runs.constData(), runs.count())));
+}
 
-    QList<Range> p = _q_collapse(currentSet);
+template <typename T>
+void BasicRangeList<T>::remove(const QList<BasicRange<T> > &ranges)
+{
+    if (ranges.isEmpty() || view().isEmpty())
+        return;
 
-    m_canonicalRanges.clear();
-    m_canonicalRanges.append(p);
+    setCanonicalRanges(_q_subtract(view(), _q_unite(_q_toSortedArray(ranges))));
 }
 
 /***********************************************************************************
  ***********************************************************************************/
-void RangeList::remove(const RangeListPtr other)
+/*!
+ * \brief Keeps only the identifiers that are also in the \a other range list.
+ */
+template <typename T>
+void BasicRangeList<T>::intersect(const QSharedPointer<BasicRangeList<T> > other)
+{
+    setCanonicalRanges(_q_intersect(view(), other->canonicalRanges()));
+}
+
+template <typename T>
+void BasicRangeList<T>::intersect(const QList<BasicRange<T> > &ranges)
 {
-    this->remove(other->ranges());
+    if (view().isEmpty())
+        return;
+
+    setCanonicalRanges(_q_intersect(view(), _q_unite(_q_toSortedArray(ranges))));
 }
 
-void RangeList::remove(const Range &range)
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Keeps the identifiers that are either in this range list or in the
+ * \a other range list, but not in both.
+ */
+template <typename T>
+void BasicRangeList<T>::symmetricDifference(const QSharedPointer<BasicRangeList<T> > other)
 {
-    QList<Range> ranges;
-    ranges << range;
-    this->remove( ranges );
+    this->_q_symmetricDifference(other->canonicalRanges());
 }
 
-void RangeList::remove(const QList<Range> &ranges)
+template <typename T>
+void BasicRangeList<T>::symmetricDifference(const QList<BasicRange<T> > &ranges)
 {
     if (ranges.isEmpty())
         return;
 
-    QSet<int> currentSet = _q_expand( m_canonicalRanges );
-    QSet<int> removedSet = _q_expand( ranges );
+    this->_q_symmetricDifference(_q_unite(_q_toSortedArray(ranges)));
+}
+
+template <typename T>
+void BasicRangeList<T>::_q_symmetricDifference(const BasicRangeSpan<T> &canonicalRanges)
+{
+    if (!view().isEmpty() && !canonicalRanges.isEmpty()) {
+        const qint64 lo = qMin(view().first().from(), canonicalRanges.first().from());
+        const qint64 hi = qMax(view().last().to(), canonicalRanges.last().to());
+        if (_q_isDense(lo, hi, view().count() + canonicalRanges.count())) {
+            setCanonicalRanges(_q_combineBits<T>(view(), canonicalRanges, lo, hi,
+                                              [](quint64 w1, quint64 w2) { return w1 ^ w2; }));
+            return;
+        }
+    }
+
+    const BasicRangeArray<T> onlyHere = _q_subtract(view(), canonicalRanges);
+    const BasicRangeArray<T> onlyThere = _q_subtract(canonicalRanges, view());
+
+    BasicRangeArray<T> merged;
+    merged.reserve(onlyHere.count() + onlyThere.count());
+    std::merge(onlyHere.constBegin(), onlyHere.constEnd(),
+               onlyThere.constBegin(), onlyThere.constEnd(),
+               std::back_inserter(merged), _q_lessThan<T>);
+
+    setCanonicalRanges(_q_unite(merged));
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Replaces the identifiers by the identifiers of \a bounds
+ * that are not in the range list.
+ *
+ * \code
+ *   // assuming RangeList ranges = { "3:5", "8" }
+ *   ranges.complement( Range(1, 10) ); // ranges == { "1", "2", "6", "7", "9", "10" }
+ * \endcode
+ */
+template <typename T>
+void BasicRangeList<T>::complement(const BasicRange<T> &bounds)
+{
+    BasicRangeArray<T> all;
+    if (!bounds.isEmpty()) {
+        all << bounds;
+        all = _q_unite(all);
+    }
+    setCanonicalRanges(_q_subtract(all, view()));
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \internal
+ * \brief Replaces the canonical ranges by the given \a ranges, and updates
+ * the prefix counts. The \a ranges are swapped in, without copy.
+ */
+template <typename T>
+void BasicRangeList<T>::setCanonicalRanges(BasicRangeArray<T> &&ranges)
+{
+    if (ranges.isEmpty()) {
+        d = sharedNull();
+        return;
+    }
 
-    currentSet -= removedSet;
+    /* The data is replaced entirely: it's reused if not shared, and otherwise
+     * new data is created, rather than detaching a copy about to be overwritten */
+    BasicRangeListData<T> *data = (d.constData()->ref.load() == 1)
+            ? d.data() : new BasicRangeListData<T>();
+    data->canonicalRanges.swap(ranges);
 
-    QList<Range> p = _q_collapse(currentSet);
+    const int count = data->canonicalRanges.count();
+    data->prefixCounts.resize(count + 1);
+    T sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += data->canonicalRanges.at(i).count();
+        data->prefixCounts[i + 1] = sum;
+    }
+    if (data != d.constData()) {
+        d = data;
+    }
+}
 
-    m_canonicalRanges.clear();
-    m_canonicalRanges.append(p);
+/*!
+ * \internal
+ * \brief Returns the number of identifiers lower than \a identifier.
+ */
+template <typename T>
+qint64 BasicRangeList<T>::_q_rank(const qint64 identifier) const
+{
+    const typename BasicRangeArray<T>::const_iterator it =
+            std::lower_bound(d->canonicalRanges.constBegin(), d->canonicalRanges.constEnd(),
+                             identifier, _q_toLessThan<T>);
+    const int i = int(it - d->canonicalRanges.constBegin());
+    if (it == d->canonicalRanges.constEnd() || identifier <= it->from())
+        return d->prefixCounts.at(i);
+    return d->prefixCounts.at(i) + (identifier - it->from() + it->by() - 1) / it->by();
 }
 
 /***********************************************************************************
  ***********************************************************************************/
-bool RangeList::operator==(const RangeList &other) const
+template <typename T>
+bool BasicRangeList<T>::operator==(const BasicRangeList<T> &other) const
 {
-    return m_canonicalRanges == other.ranges();
+    return d == other.d || d->canonicalRanges == other.d->canonicalRanges;
 }
 
-bool RangeList::operator!=(const RangeList &other) const
+template <typename T>
+bool BasicRangeList<T>::operator!=(const BasicRangeList<T> &other) const
 {
     return ((*this) == other) ? false : true;
 }
@@ -160,17 +1231,18 @@ bool RangeList::operator!=(const RangeList &other) const
  *    {"5" "10:12:1" "20" "25"} -> {5, 10, 11, 12, 20, 25}
  *
  * \remark
- * Since this method handles QSet<int>, it can take a notable time for adding large
+ * Since this method handles QSet<T>, it can take a notable time for adding large
  * ranges. Noticable issues appear with ranges containing more than 1 million of
  * identifiers (ex: "1:1000000").
  *
  * \sa _q_collapse()
  */
-QSet<int> RangeList::_q_expand(const QList<Range> &ranges)
+template <typename T>
+QSet<T> BasicRangeList<T>::_q_expand(const QList<BasicRange<T> > &ranges)
 {
-    QSet<int> res;
+    QSet<T> res;
     foreach (auto item, ranges) {
-        for (Identifier i = item.from(); i <= item.to(); i += item.by()) {
+        for (T i = item.from(); i <= item.to(); i += item.by()) {
             res.insert(i);
         }
     }
@@ -190,69 +1262,426 @@ QSet<int> RangeList::_q_expand(const QList<Range> &ranges)
  *
  * \sa _q_expand()
  */
-QList<Range> RangeList::_q_collapse(const QSet<int> &identifiers)
+template <typename T>
+QList<BasicRange<T> > BasicRangeList<T>::_q_collapse(const QSet<T> &identifiers)
 {
-    QList<Range> res;
+    QVector<T> values;
+    values.reserve(identifiers.count());
+    foreach (auto identifier, identifiers) {
+        values.append(identifier);
+    }
 
-    QList<int> list = identifiers.toList();
-    if (list.isEmpty()) {
-        return res;
+    QList<BasicRange<T> > res;
+    for (const BasicRange<T> &range : _q_collapseUnsorted(values)) {
+        res << range;
     }
+    return res;
+}
+
+/*!
+ * \internal
+ * \brief Returns the canonical ranges of the sorted and duplicate-free identifiers
+ * in [\a begin, \a end).
+ */
+template <typename T>
+static BasicRangeArray<T> _q_collapseSorted(const T *begin, const T *end)
+{
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
+    _q_pushSorted(begin, int(end - begin), packer);
+    packer.finish();
+    return res;
+}
 
-    qSort(list);
-    // Rem: At this point, the list is sorted and duplicate-free.
+/*!
+ * \internal
+ * \brief Collapses the unsorted \a identifiers on \a parts threads.
+ *
+ * The identifiers are partitioned by key interval, the bounds being taken at
+ * the quantiles of a sample. Each thread counts then scatters its chunk of
+ * the input in the partitions, then each partition is sorted and collapsed on
+ * its own thread. Finally the partitions are stitched.
+ */
+template <typename T>
+static BasicRangeArray<T> _q_collapseParallel(const QVector<T> &identifiers, const int parts)
+{
+    const T max = BasicRange<T>::maximum();
+    const int count = identifiers.count();
+    const T *values = identifiers.constData();
 
-    const int count = list.count();
+    /* Partition bounds */
+    QVector<T> sample;
+    const int sampleCount = 64 * parts;
+    for (int k = 0; k < sampleCount; ++k) {
+        const T value = values[int(qint64(count) * k / sampleCount)];
+        if (value > 0 && value <= max) {
+            sample.append(value);
+        }
+    }
+    std::sort(sample.begin(), sample.end());
+    QVector<T> splitters;
+    for (int p = 1; p < parts && !sample.isEmpty(); ++p) {
+        const T splitter = sample.at(sample.count() * p / parts);
+        if (splitters.isEmpty() || splitter > splitters.last()) {
+            splitters.append(splitter);
+        }
+    }
+    const int partitionCount = splitters.count() + 1;
+    auto partitionOf = [&splitters](const T value) {
+        return int(std::upper_bound(splitters.constBegin(), splitters.constEnd(), value)
+                   - splitters.constBegin());
+    };
 
-    int range_begin = 0;
-    int range_end = 0;
-    int range_step = 0;
-    int previous_val_0 = -1;
-    int val_0 = 0;
-    int val_1 = 0;
-    int val_2 = 0;
-    int delta_1 = 0;
-    int delta_2 = 0;
+    /* offsets[c * partitionCount + p] is where the chunk c scatters in the partition p */
+    QVector<int> offsets(parts * partitionCount, 0);
+    int *chunkOffsets = offsets.data();
+    _q_runParallel(parts, [&](const int c) {
+        int *counts = chunkOffsets + c * partitionCount;
+        const int chunkEnd = int(qint64(count) * (c + 1) / parts);
+        for (int i = int(qint64(count) * c / parts); i < chunkEnd; ++i) {
+            const T value = values[i];
+            if (value > 0 && value <= max) {
+                counts[partitionOf(value)]++;
+            }
+        }
+    });
 
-    for (int i = 0; i < count; ++i) {
+    QVector<int> partitionBegins(partitionCount + 1);
+    int offset = 0;
+    for (int p = 0; p < partitionCount; ++p) {
+        partitionBegins[p] = offset;
+        for (int c = 0; c < parts; ++c) {
+            const int chunkCount = chunkOffsets[c * partitionCount + p];
+            chunkOffsets[c * partitionCount + p] = offset;
+            offset += chunkCount;
+        }
+    }
+    partitionBegins[partitionCount] = offset;
 
-        val_0 = list.at(i);
+    QVector<T> buffer(offset);
+    T *partitioned = buffer.data();
+    _q_runParallel(parts, [&](const int c) {
+        int *next = chunkOffsets + c * partitionCount;
+        const int chunkEnd = int(qint64(count) * (c + 1) / parts);
+        for (int i = int(qint64(count) * c / parts); i < chunkEnd; ++i) {
+            const T value = values[i];
+            if (value > 0 && value <= max) {
+                partitioned[next[partitionOf(value)]++] = value;
+            }
+        }
+    });
 
-        if (val_0 == previous_val_0)   // Skip duplicate
-            continue;
+    QVector<BasicRangeArray<T> > results(partitionCount);
+    BasicRangeArray<T> *out = results.data();
+    _q_runParallel(partitionCount, [&](const int p) {
+        T *begin = partitioned + partitionBegins.at(p);
+        T *end = partitioned + partitionBegins.at(p + 1);
+        _q_radixSort(begin, int(end - begin));
+        end = std::unique(begin, end);
+        out[p] = _q_collapseSorted(begin, end);
+    });
+
+    return _q_stitch(results);
+}
+
+/*!
+ * \internal
+ * \brief Collapses the unsorted \a identifiers, whose valid ones are in [\a lo, \a hi],
+ * with a bitset instead of a sort.
+ */
+template <typename T>
+static BasicRangeArray<T> _q_collapseDense(const QVector<T> &identifiers,
+                                           const qint64 lo, const qint64 hi)
+{
+    QVector<quint64> words(int((hi - lo) / 64 + 1), 0);
+    quint64 *data = words.data();
+    foreach (auto identifier, identifiers) {
+        if (identifier >= lo && identifier <= hi) {
+            _q_setBit(data, int(identifier - lo));
+        }
+    }
+    return _q_fromBits<T>(words, lo);
+}
 
-        previous_val_0 = val_0;
+/*!
+ * \brief Collapse the given unsorted \a identifiers, that might contain duplicates.
+ * Return the canonical ranges, like _q_collapse().
+ *
+ * The \a identifiers are sorted in place with a radix sort, then deduplicated,
+ * thus nothing is hashed nor compared. The identifiers that can't be
+ * held by a range are ignored.
+ *
+ * Large inputs are partitioned, then sorted and collapsed on several threads.
+ * Dense inputs, that fill a large part of their interval, are not sorted:
+ * they are collapsed with a bitset.
+ */
+template <typename T>
+BasicRangeArray<T> BasicRangeList<T>::_q_collapseUnsorted(QVector<T> &identifiers)
+{
+    if (identifiers.count() >= C_DENSE_MIN_COUNT) {
+        const T max = BasicRange<T>::maximum();
+        qint64 lo = max;
+        qint64 hi = 0;
+        foreach (auto identifier, identifiers) {
+            if (identifier > 0 && identifier <= max) {
+                lo = qMin(lo, qint64(identifier));
+                hi = qMax(hi, qint64(identifier));
+            }
+        }
+        if (_q_isDense(lo, hi, identifiers.count()))
+            return _q_collapseDense(identifiers, lo, hi);
+    }
 
-        if (i < count - 2) {
+    const int parts = qMin(QThread::idealThreadCount(),
+                           identifiers.count() / C_PARALLEL_COLLAPSE_GRAIN);
+    if (parts >= 2)
+        return _q_collapseParallel(identifiers, parts);
 
-            val_1 = list.at(i+1);
-            val_2 = list.at(i+2);
-            delta_1 = val_1 - val_0;
-            delta_2 = val_2 - val_1;
+    const T max = BasicRange<T>::maximum();
+    T *begin = identifiers.data();
+    T *end = std::remove_if(begin, begin + identifiers.count(),
+                            [max](const T identifier) { return identifier <= 0 || identifier > max; });
+    _q_radixSort(begin, int(end - begin));
+    end = std::unique(begin, end);
+    return _q_collapseSorted(begin, end);
+}
 
-            if ( delta_2 == delta_1 ) {
-                if ( range_begin == 0) {
-                    range_begin = val_0;
-                }
-                range_end  = val_2;
-                range_step = delta_2;
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Unites the given \a sortedRanges.
+ * Return the canonical ranges of the union, like _q_collapse(_q_expand(sortedRanges)).
+ *
+ * The \a sortedRanges must be sorted by their first identifier, but they can
+ * overlap, be interleaved or contain duplicates.
+ *
+ * Example:
+ *    {"1:9:2" "2:10:2" "20" "25:30"} -> {"1:10" "20" "25:30"}
+ *
+ * \remark The identifiers are never expanded: the ranges are swept window by
+ * window, a window being delimited by the beginning or the end of a range.
+ * Hence, the cost depends on the number of ranges, not on the number of identifiers.
+ * Many ranges in a short interval are united with a bitset instead.
+ *
+ * \sa _q_collapse()
+ */
+template <typename T>
+BasicRangeArray<T> BasicRangeList<T>::_q_unite(const BasicRangeSpan<T> &sortedRanges)
+{
+    if (sortedRanges.count() >= C_DENSE_MIN_COUNT) {
+        qint64 lo = BasicRange<T>::maximum();
+        qint64 hi = 0;
+        for (int i = 0; i < sortedRanges.count(); ++i) {
+            const BasicRange<T> &range = sortedRanges.at(i);
+            if (!range.isEmpty()) {
+                lo = qMin(lo, qint64(range.from()));
+                hi = qMax(hi, qint64(range.to()));
+            }
+        }
+        if (_q_isDense(lo, hi, sortedRanges.count()))
+            return _q_fromBits<T>(_q_toBits(sortedRanges, lo, hi), lo);
+    }
+
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
+    _q_sweep(sortedRanges, packer);
+    packer.finish();
+    return res;
+}
+
+/*!
+ * \brief Unites the given \a sortedRanges, like _q_unite(), but on several threads.
+ *
+ * The identifiers are split in intervals holding about the same number of ranges.
+ * Each interval is united in its own thread, then the results are stitched.
+ *
+ * Small inputs are united in the calling thread.
+ */
+template <typename T>
+BasicRangeArray<T> BasicRangeList<T>::_q_uniteParallel(const BasicRangeSpan<T> &sortedRanges)
+{
+    const int count = sortedRanges.count();
+    const int parts = qMin(QThread::idealThreadCount(), count / C_PARALLEL_GRAIN);
+    if (parts < 2)
+        return _q_unite(sortedRanges);
+
+    /* Interval bounds, at the start of evenly spaced ranges */
+    QVector<qint64> bounds;
+    bounds.append(sortedRanges.first().from());
+    for (int p = 1; p < parts; ++p) {
+        const qint64 bound = sortedRanges.at(int(qint64(count) * p / parts)).from();
+        if (bound > bounds.last()) {
+            bounds.append(bound);
+        }
+    }
+    bounds.append(qint64(BasicRange<T>::maximum()) + 1);
+
+    /* maxTo[i] is the last identifier of the i+1 first ranges, so that
+     * an interval skips the ranges that end before it */
+    QVector<qint64> maxTo(count);
+    qint64 last = 0;
+    for (int i = 0; i < count; ++i) {
+        last = qMax(last, qint64(sortedRanges.at(i).to()));
+        maxTo[i] = last;
+    }
+
+    QVector<BasicRangeArray<T> > results(bounds.count() - 1);
+    BasicRangeArray<T> *out = results.data();
+    _q_runParallel(results.count(), [&](const int p) {
+        const qint64 lo = bounds.at(p);
+        const qint64 hi = bounds.at(p + 1) - 1;
+        const int begin = int(std::lower_bound(maxTo.constBegin(), maxTo.constEnd(), lo)
+                              - maxTo.constBegin());
+        const int end = int(std::upper_bound(sortedRanges.constBegin(), sortedRanges.constEnd(),
+                                             BasicRange<T>(T(hi)), _q_lessThan<T>)
+                            - sortedRanges.constBegin());
+
+        /* Clip the ranges to the interval. The ranges that start before it
+         * might be overtaken by the clipped ones, hence the sort. */
+        BasicRangeArray<T> clipped;
+        for (int i = begin; i < end; ++i) {
+            const BasicRange<T> &range = sortedRanges.at(i);
+            const qint64 from = range.from();
+            const qint64 by = range.by();
+            if (range.to() < lo)
                 continue;
+            const qint64 first = (lo <= from) ? from : from + ((lo - from + by - 1) / by) * by;
+            const qint64 to = qMin(hi, qint64(range.to()));
+            if (first <= to) {
+                const qint64 last = first + ((to - first) / by) * by;
+                clipped.append(BasicRange<T>(T(first), T(last), T(by)));
             }
         }
+        std::sort(clipped.begin(), clipped.end(), _q_lessThan<T>);
+        out[p] = _q_unite(clipped);
+    });
 
-        if (range_begin != 0) { // Compact insertion
+    return _q_stitch(results);
+}
 
-            Range r(range_begin, range_end, range_step);
-            res << r;
-            range_begin = 0;
-            i++;
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Subtracts the \a removedRanges from the \a canonicalRanges.
+ * Return the canonical ranges of the difference, like
+ * _q_collapse(_q_expand(canonicalRanges) - _q_expand(removedRanges)).
+ *
+ * Both lists must be canonical.
+ *
+ * Example:
+ *    {"10:99"} - {"45:67"} -> {"10:44" "68:99"}
+ *
+ * \remark The identifiers are never expanded. The two lists are walked in
+ * parallel, and each range is only split where it overlaps a removed range.
+ * The common identifiers of two overlapping ranges are found with the Chinese
+ * remainder theorem, thus the cost depends on the number of touched ranges.
+ *
+ * \sa _q_unite()
+ */
+template <typename T>
+BasicRangeArray<T> BasicRangeList<T>::_q_subtract(const BasicRangeSpan<T> &canonicalRanges,
+                                                  const BasicRangeSpan<T> &removedRanges)
+{
+    if (!canonicalRanges.isEmpty()) {
+        const qint64 lo = canonicalRanges.first().from();
+        const qint64 hi = canonicalRanges.last().to();
+        if (_q_isDense(lo, hi, canonicalRanges.count() + removedRanges.count()))
+            return _q_combineBits(canonicalRanges, removedRanges, lo, hi,
+                                  [](quint64 w1, quint64 w2) { return w1 & ~w2; });
+    }
+
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
+
+    const int removedCount = removedRanges.count();
+    int j = 0;
+
+    for (const BasicRange<T> &range : canonicalRanges) {
+        const qint64 from = range.from();
+        const qint64 to = range.to();
+
+        while (j < removedCount && removedRanges.at(j).to() < from) {
+            j++;
+        }
+
+        qint64 pos = from;
+        int k = j;
+        while (k < removedCount && removedRanges.at(k).from() <= to) {
+            const BasicRange<T> &removed = removedRanges.at(k);
+            const qint64 lo = qMax(pos, qint64(removed.from()));
+            const qint64 hi = qMin(to, qint64(removed.to()));
+
+            _q_push_between(range, pos, lo - 1, packer);
+            _q_subtract_window(range, removed, lo, hi, packer);
+            pos = hi + 1;
+
+            if (removed.to() > to)
+                break; /* The removed range overlaps the next range too. */
+            k++;
+        }
+        _q_push_between(range, pos, to, packer);
+        j = k;
+    }
+    packer.finish();
+    return res;
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Intersects the \a canonicalRanges1 with the \a canonicalRanges2.
+ * Return the canonical ranges of the identifiers common to both lists.
+ *
+ * Both lists must be canonical.
+ *
+ * Example:
+ *    {"1:20" "30:40:2"} & {"15:35:5"} -> {"15" "20" "30"}
+ *
+ * \remark The two lists are walked in parallel, and each pair of overlapping
+ * ranges is intersected with Range::intersected(). Since the ranges of a canonical
+ * list don't overlap, the pieces come in order and the cost is linear in the
+ * number of ranges.
+ *
+ * \sa _q_subtract()
+ */
+template <typename T>
+BasicRangeArray<T> BasicRangeList<T>::_q_intersect(const BasicRangeSpan<T> &canonicalRanges1,
+                                                   const BasicRangeSpan<T> &canonicalRanges2)
+{
+    const int count1 = canonicalRanges1.count();
+    const int count2 = canonicalRanges2.count();
+    if (count1 > 0 && count2 > 0) {
+        const qint64 lo = qMax(canonicalRanges1.first().from(), canonicalRanges2.first().from());
+        const qint64 hi = qMin(canonicalRanges1.last().to(), canonicalRanges2.last().to());
+        if (_q_isDense(lo, hi, count1 + count2))
+            return _q_combineBits(canonicalRanges1, canonicalRanges2, lo, hi,
+                                  [](quint64 w1, quint64 w2) { return w1 & w2; });
+    }
 
-        } else { // Normal insertion
+    BasicRangeArray<T> res;
+    RangePacker<T> packer(&res);
 
-            Range r(val_0, val_0, 1);
-            res << r;
+    int i = 0;
+    int j = 0;
+    while (i < count1 && j < count2) {
+        const BasicRange<T> &r1 = canonicalRanges1.at(i);
+        const BasicRange<T> &r2 = canonicalRanges2.at(j);
 
+        const BasicRange<T> common = r1.intersected(r2);
+        if (!common.isEmpty()) {
+            packer.push(common.from(), common.to(), common.by());
+        }
+        if (r1.to() < r2.to()) {
+            i++;
+        } else {
+            j++;
         }
     }
+    packer.finish();
     return res;
 }
+
+/***********************************************************************************
+ ***********************************************************************************/
+template class BasicRangeList<Identifier>;
+template class BasicRangeList<Identifier64>;
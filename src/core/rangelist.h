@@ -26,46 +26,154 @@
 #define RANGELIST_H
 
 #include "range.h"
+#include "rangeblock.h"
 
 #include <QtCore/QList>
 #include <QtCore/QSet>
 #include <QtCore/QString>
+#include <QtCore/QSharedData>
+#include <QtCore/QSharedDataPointer>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
 
-class RangeList;
-typedef QSharedPointer<RangeList> RangeListPtr;
+template <typename T> class BasicChunkedRangeList;
+template <typename T> class BasicExternalSorter;
+template <typename T> class BasicRangeListBuilder;
+
+/*!
+ * \struct PackingCost
+ * \brief The PackingCost struct is the cost of the packed ranges,
+ * that BasicRangeList::optimalRanges() minimizes.
+ *
+ * The cost of a range is a fixed cost, depending on the kind of range,
+ * plus a cost for each digit of its bounds and of its step.
+ */
+struct PackingCost
+{
+    int single;  ///< Fixed cost of a single identifier, like "5".
+    int range;   ///< Fixed cost of a continuous range, like "5:9".
+    int strided; ///< Fixed cost of a strided range, like "5:9:2".
+    int digit;   ///< Cost of each written digit.
+
+    static PackingCost rangeCount();
+    static PackingCost patranText();
+    static PackingCost nastranFields();
+};
+
+/*!
+ * \internal
+ * \class BasicRangeListData
+ * \brief The BasicRangeListData class is the implicitly shared data of BasicRangeList.
+ */
+template <typename T>
+class BasicRangeListData : public QSharedData
+{
+public:
+    BasicRangeListData() { prefixCounts.append(0); }
+
+    BasicRangeArray<T> canonicalRanges; ///< Canonical ranges.
+    ///  This is the sorted list of ranges without duplicates
+    ///  identifiers, packed greedily from the left.
+    ///  It's unique, but not always the shortest one: see optimalRanges().
+    ///  Stored contiguously, since every operation walks it from start to end.
+
+    QVector<T> prefixCounts; ///< Prefix counts.
+    ///  prefixCounts[i] is the number of identifiers in the i first ranges,
+    ///  so it has one more item than canonicalRanges.
+};
 
-class RangeList
+/*!
+ * \class BasicRangeList
+ * \brief The BasicRangeList class is a set of identifiers of type \a T,
+ * stored as canonical ranges.
+ *
+ * BasicRangeList is implicitly shared: copying it is O(1), and the copies
+ * share their ranges until one of them is modified. An operation never modifies
+ * the shared ranges in place, it gives the modified list its own new ranges.
+ * Thus a copy is a snapshot, that can be handed to another thread.
+ *
+ * Use RangeList for 32-bit identifiers, and RangeList64 for 64-bit identifiers.
+ */
+template <typename T>
+class BasicRangeList
 {
 public:
-    explicit RangeList();
+    explicit BasicRangeList();
 
     void clear();
-    int count() const;
+    T count() const;
     int countRanges() const;
 
-    QList<Range> ranges() const;
+    QList<BasicRange<T> > ranges() const;
+    const BasicRangeArray<T> &canonicalRanges() const;
+    BasicRangeSpan<T> view() const;
+    QList<BasicRange<T> > optimalRanges(const PackingCost &cost) const;
+    QList<BasicRangeBlock<T> > blocks() const;
+
+    bool contains(const T identifier) const;
+    T rank(const T identifier) const;
+    T select(const T index) const;
+    T countInInterval(const T from, const T to) const;
+
+    void add(const QSharedPointer<BasicRangeList<T> > other);
+    void add(const BasicRangeList<T> &other);
+    void add(BasicRangeList<T> &&other);
+    void add(const BasicRangeSpan<T> &canonicalRanges);
+    void add(const BasicRange<T> &range);
+    void add(const BasicRangeBlock<T> &block);
+    void add(const QList<BasicRange<T> > &ranges);
+    void add(const QList<QSharedPointer<BasicRangeList<T> > > &others);
+    void add(const QVector<T> &identifiers);
+
+    void remove(const QSharedPointer<BasicRangeList<T> > other);
+    void remove(const BasicRangeList<T> &other);
+    void remove(const BasicRangeSpan<T> &canonicalRanges);
+    void remove(const BasicRange<T> &range);
+    void remove(const BasicRangeBlock<T> &block);
+    void remove(const QList<BasicRange<T> > &ranges);
 
-    void add(const RangeListPtr other);
-    void add(const Range &range);
-    void add(const QList<Range> &ranges);
+    void intersect(const QSharedPointer<BasicRangeList<T> > other);
+    void intersect(const QList<BasicRange<T> > &ranges);
 
-    void remove(const RangeListPtr other);
-    void remove(const Range &range);
-    void remove(const QList<Range> &ranges);
+    void symmetricDifference(const QSharedPointer<BasicRangeList<T> > other);
+    void symmetricDifference(const QList<BasicRange<T> > &ranges);
 
-    bool operator==(const RangeList &other) const;
-    bool operator!=(const RangeList &other) const;
+    void complement(const BasicRange<T> &bounds);
+
+    bool operator==(const BasicRangeList<T> &other) const;
+    bool operator!=(const BasicRangeList<T> &other) const;
 
 protected:
-    static QSet<int> _q_expand(const QList<Range> &ranges);
-    static QList<Range> _q_collapse(const QSet<int> &identifiers);
+    static QSet<T> _q_expand(const QList<BasicRange<T> > &ranges);
+    static QList<BasicRange<T> > _q_collapse(const QSet<T> &identifiers);
+    static BasicRangeArray<T> _q_collapseUnsorted(QVector<T> &identifiers);
+    static BasicRangeArray<T> _q_unite(const BasicRangeSpan<T> &sortedRanges);
+    static BasicRangeArray<T> _q_uniteParallel(const BasicRangeSpan<T> &sortedRanges);
+    static BasicRangeArray<T> _q_subtract(const BasicRangeSpan<T> &canonicalRanges,
+                                          const BasicRangeSpan<T> &removedRanges);
+    static BasicRangeArray<T> _q_intersect(const BasicRangeSpan<T> &canonicalRanges1,
+                                           const BasicRangeSpan<T> &canonicalRanges2);
 
 private:
-    QList<Range> m_canonicalRanges; ///< Canonical ranges.
-    ///  This is the shortest sorted list of
-    ///  ranges without duplicates identifiers.
+    friend class BasicChunkedRangeList<T>;
+    friend class BasicExternalSorter<T>;
+    friend class BasicRangeListBuilder<T>;
+
+    void _q_add(const BasicRangeSpan<T> &sortedRanges);
+    void _q_addSmall(const BasicRangeSpan<T> &sortedRanges);
+    void _q_symmetricDifference(const BasicRangeSpan<T> &canonicalRanges);
+    void setCanonicalRanges(BasicRangeArray<T> &&ranges);
+    qint64 _q_rank(const qint64 identifier) const;
+
+    static BasicRangeListData<T> *sharedNull();
+
+    QSharedDataPointer<BasicRangeListData<T> > d;
 
 };
 
+typedef BasicRangeList<Identifier> RangeList;
+typedef BasicRangeList<Identifier64> RangeList64;
+typedef QSharedPointer<RangeList> RangeListPtr;
+typedef QSharedPointer<RangeList64> RangeList64Ptr;
+
 #endif // RANGELIST_H
@@ -0,0 +1,137 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rangelistbuilder.h"
+#include "range_p.h"
+
+#include <QtCore/QVector>
+#include <algorithm>
+#include <iterator>
+
+/***********************************************************************************
+ ***********************************************************************************/
+template <typename T>
+BasicRangeListBuilder<T>::BasicRangeListBuilder()
+{
+}
+
+template <typename T>
+void BasicRangeListBuilder<T>::clear()
+{
+    m_identifiers.clear();
+    m_ranges.clear();
+}
+
+template <typename T>
+bool BasicRangeListBuilder<T>::isEmpty() const
+{
+    return m_identifiers.isEmpty() && m_ranges.isEmpty();
+}
+
+/*!
+ * \brief Returns the number of identifiers and ranges added since the last finish().
+ */
+template <typename T>
+int BasicRangeListBuilder<T>::count() const
+{
+    return m_identifiers.count() + m_ranges.count();
+}
+
+/*!
+ * \brief Reserves the memory for \a identifierCount single identifiers,
+ * and \a rangeCount ranges.
+ */
+template <typename T>
+void BasicRangeListBuilder<T>::reserve(const int identifierCount, const int rangeCount)
+{
+    m_identifiers.reserve(identifierCount);
+    m_ranges.reserve(rangeCount);
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Adds the given \a identifier. It's only appended, in constant time.
+ *
+ * Identifiers that can't be held by a range are ignored by finish().
+ */
+template <typename T>
+void BasicRangeListBuilder<T>::add(const T identifier)
+{
+    m_identifiers.append(identifier);
+}
+
+template <typename T>
+void BasicRangeListBuilder<T>::add(const BasicRange<T> &range)
+{
+    if (range.isEmpty())
+        return;
+    if (range.count() == 1) {
+        m_identifiers.append(range.from());
+        return;
+    }
+    m_ranges.append(range);
+}
+
+template <typename T>
+void BasicRangeListBuilder<T>::add(const BasicRangeBlock<T> &block)
+{
+    foreach (auto run, block.runs()) {
+        add(run);
+    }
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Adds all the collected identifiers and ranges to \a result, and clears
+ * the builder.
+ *
+ * The single identifiers are collapsed at once, like BasicRangeList::add() does
+ * for a QVector, the ranges are sorted, and both are united with the canonical
+ * ranges of \a result in one pass.
+ */
+template <typename T>
+void BasicRangeListBuilder<T>::finish(BasicRangeList<T> &result)
+{
+    if (isEmpty())
+        return;
+
+    const BasicRangeArray<T> collapsed = BasicRangeList<T>::_q_collapseUnsorted(m_identifiers);
+    std::sort(m_ranges.begin(), m_ranges.end(), _q_lessThan<T>);
+
+    BasicRangeArray<T> merged;
+    merged.reserve(collapsed.count() + m_ranges.count());
+    std::merge(collapsed.constBegin(), collapsed.constEnd(),
+               m_ranges.constBegin(), m_ranges.constEnd(),
+               std::back_inserter(merged), _q_lessThan<T>);
+    result._q_add(merged);
+
+    this->clear();
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+template class BasicRangeListBuilder<Identifier>;
+template class BasicRangeListBuilder<Identifier64>;
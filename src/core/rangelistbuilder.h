@@ -0,0 +1,77 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the MIT License.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RANGELISTBUILDER_H
+#define RANGELISTBUILDER_H
+
+#include "rangelist.h"
+
+#include <QtCore/QVector>
+
+/*!
+ * \class BasicRangeListBuilder
+ * \brief The BasicRangeListBuilder class collects identifiers and ranges of
+ * type \a T, and canonicalizes them all at once.
+ *
+ * Adding to a BasicRangeList canonicalizes its ranges at each call, thus
+ * adding the tokens of a text one by one is quadratic. The builder only
+ * appends them, and unites them in one pass in finish().
+ *
+ * \code
+ *   RangeListBuilder builder;
+ *   builder.add( 12 );
+ *   builder.add( Range(1, 10) );
+ *   RangeList result;
+ *   builder.finish( result ); // result == { "1:10", "12" }
+ * \endcode
+ *
+ * Use RangeListBuilder for 32-bit identifiers, and RangeListBuilder64 for
+ * 64-bit identifiers.
+ */
+template <typename T>
+class BasicRangeListBuilder
+{
+public:
+    explicit BasicRangeListBuilder();
+
+    void clear();
+    bool isEmpty() const;
+    int count() const;
+    void reserve(const int identifierCount, const int rangeCount = 0);
+
+    void add(const T identifier);
+    void add(const BasicRange<T> &range);
+    void add(const BasicRangeBlock<T> &block);
+
+    void finish(BasicRangeList<T> &result);
+
+private:
+    QVector<T> m_identifiers;      ///< Single identifiers, unsorted.
+    BasicRangeArray<T> m_ranges;   ///< Ranges, unsorted.
+};
+
+typedef BasicRangeListBuilder<Identifier> RangeListBuilder;
+typedef BasicRangeListBuilder<Identifier64> RangeListBuilder64;
+
+#endif // RANGELISTBUILDER_H
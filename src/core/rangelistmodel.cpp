@@ -30,6 +30,8 @@
 #include <Core/RangeHelper>
 #include <Core/RangeList>
 
+#include <utility>
+
 /*!
  * \class RangeListModel
  * \brief A simple model that uses a RangeList as its data source.
@@ -50,7 +52,7 @@ void RangeListModelPrivate::synchonize()
 {
     RangeHelper *rh = RangeHelper::instance();
     m_displayedList.clear();
-    foreach (auto range, m_internalRangeList.ranges()) {
+    for (const Range &range : m_internalRangeList.view()) {
         if (m_isPacked) {
             QString str = rh->toPackedString( range );
             m_displayedList.append( str );
@@ -134,8 +136,9 @@ void RangeListModel::add(const QString &text)
     if (!text.isEmpty()) {
         emit beginResetModel();
         Parser *p = Parser::instance();
-        const RangeListPtr parsedList = p->parse( text );
-        d->m_internalRangeList.add( parsedList );
+        RangeList parsedList;
+        p->parse( text, parsedList );
+        d->m_internalRangeList.add( std::move(parsedList) );
         d->synchonize();
         emit endResetModel();
         emit countChanged(d->m_internalRangeList.count());
@@ -151,7 +154,8 @@ void RangeListModel::remove(const QString &text)
     if (!text.isEmpty()) {
         emit beginResetModel();
         Parser *p = Parser::instance();
-        const RangeListPtr parsedList = p->parse( text );
+        RangeList parsedList;
+        p->parse( text, parsedList );
         d->m_internalRangeList.remove( parsedList );
         d->synchonize();
         emit endResetModel();
@@ -159,3 +163,24 @@ void RangeListModel::remove(const QString &text)
     }
 }
 
+/***********************************************************************************
+ ***********************************************************************************/
+/*!
+ * \brief Returns the range list displayed by the model.
+ */
+RangeList RangeListModel::rangeList() const
+{
+    return d->m_internalRangeList;
+}
+
+/*!
+ * \brief Replaces the content of the model by the given \a rangeList.
+ */
+void RangeListModel::setRangeList(const RangeList &rangeList)
+{
+    emit beginResetModel();
+    d->m_internalRangeList = rangeList;
+    d->synchonize();
+    emit endResetModel();
+    emit countChanged(d->m_internalRangeList.count());
+}
@@ -45,6 +45,9 @@ public:
     void add(const QString &text);
     void remove(const QString &text);
 
+    RangeList rangeList() const;
+    void setRangeList(const RangeList &rangeList);
+
     void setPacked(bool packed);
     bool isPacked() const;
 
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+# VECTOR KERNELS
+#-------------------------------------------------
+# The digit conversion of the parser (decimal_p.h) and the progression
+# detection of the collapse (range_p.h) have SSE4.1 and AVX2 kernels,
+# that are compiled only for the CPUs that have them:
+#
+#     $ qmake CONFIG+=simd
+#
+# The default build runs on any CPU, with the scalar loops, and SSE2 on x86-64.
+simd {
+    gcc|clang {
+        QMAKE_CXXFLAGS += -msse4.1 -mavx2
+    } else {
+        warning("CONFIG+=simd is only supported with GCC and Clang")
+    }
+}
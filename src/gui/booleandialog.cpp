@@ -39,3 +39,53 @@ BooleanDialog::~BooleanDialog()
 {
     delete ui;
 }
+
+/*!
+ * \brief Returns the boolean operation chosen by the user.
+ */
+BooleanDialog::Operation BooleanDialog::operation() const
+{
+    if (ui->pushButtonOr->isChecked())
+        return Union;
+    if (ui->pushButtonXor->isChecked())
+        return SymmetricDifference;
+    if (ui->pushButtonNot->isChecked())
+        return Difference;
+    if (ui->pushButtonComplement->isChecked())
+        return Complement;
+    return Intersection;
+}
+
+/*!
+ * \brief Returns true if the (A) list is the global set, i.e. the current list.
+ * Otherwise the (A) list is given by customSetText().
+ */
+bool BooleanDialog::isGlobalSet() const
+{
+    return ui->radioButtonGlobalSet->isChecked();
+}
+
+/*!
+ * \brief Returns the text of the (A) list, when it is a custom set.
+ */
+QString BooleanDialog::customSetText() const
+{
+    return ui->plainTextEditA->toPlainText();
+}
+
+/*!
+ * \brief Returns the text of the (B) list.
+ */
+QString BooleanDialog::setText() const
+{
+    return ui->plainTextEditB->toPlainText();
+}
+
+/*!
+ * \brief Returns the identifiers in which the (A) list is complemented,
+ * for the Complement operation.
+ */
+Range BooleanDialog::bounds() const
+{
+    return Range(ui->spinBoxFrom->value(), ui->spinBoxTo->value(), 1);
+}
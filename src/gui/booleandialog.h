@@ -25,6 +25,8 @@
 #ifndef BOOLEANDIALOG_H
 #define BOOLEANDIALOG_H
 
+#include <Core/Range>
+
 #include <QtWidgets/QDialog>
 
 namespace Ui {
@@ -36,9 +38,24 @@ class BooleanDialog : public QDialog
     Q_OBJECT
 
 public:
+    enum Operation {
+        Intersection,       ///< (A) AND (B)
+        Union,              ///< (A) OR (B)
+        SymmetricDifference,///< (A) XOR (B)
+        Difference,         ///< (A) NOT (B)
+        Complement          ///< NOT (A), within the bounds
+    };
+
     explicit BooleanDialog(QWidget *parent = 0);
     ~BooleanDialog();
 
+    Operation operation() const;
+
+    bool isGlobalSet() const;
+    QString customSetText() const;
+    QString setText() const;
+    Range bounds() const;
+
 private:
     Ui::BooleanDialog *ui;
 };
@@ -29,6 +29,7 @@
 #include "globals.h"
 
 #include <Core/Exporter>
+#include <Core/Parser>
 #include <Core/RangeListModel>
 #include <GUI/BooleanDialog>
 #include <GUI/VerticalToolBar>
@@ -121,10 +122,26 @@ void MainWindow::removeSelected()
 }
 
 void MainWindow::boolean()
-{    
-    QMessageBox msgBox(QMessageBox::NoIcon, QLatin1String("Info"),
-                       QLatin1String("Not implemented yet"));
-    msgBox.exec();
+{
+    Q_ASSERT(m_rangeListModel);
+    BooleanDialog dialog(this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    Parser *p = Parser::instance();
+    RangeList result = dialog.isGlobalSet()
+            ? m_rangeListModel->rangeList()
+            : *p->parse( dialog.customSetText() );
+    const RangeListPtr other = p->parse( dialog.setText() );
+
+    switch (dialog.operation()) {
+    case BooleanDialog::Intersection:        result.intersect(other);           break;
+    case BooleanDialog::Union:               result.add(other);                 break;
+    case BooleanDialog::SymmetricDifference: result.symmetricDifference(other); break;
+    case BooleanDialog::Difference:          result.remove(other);              break;
+    case BooleanDialog::Complement:          result.complement(dialog.bounds()); break;
+    }
+    m_rangeListModel->setRangeList(result);
 }
 
 
@@ -164,8 +181,8 @@ void MainWindow::copyAll()
  ***********************************************************************************/
 void MainWindow::clear()
 {
-    this->selectAll();
-    this->removeSelected();
+    Q_ASSERT(m_rangeListModel);
+    m_rangeListModel->clear();
 }
 
 
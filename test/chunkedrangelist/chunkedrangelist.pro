@@ -0,0 +1,25 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_chunkedrangelist
+CONFIG      += testcase
+QT           = core testlib
+SOURCES     += tst_chunkedrangelist.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
+
+# Dependancies:
+HEADERS += ../shared/utils.h
+SOURCES += ../shared/utils.cpp
+
+HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
+SOURCES += ../../src/core/range.cpp
+HEADERS += ../../src/core/rangeblock.h
+SOURCES += ../../src/core/rangeblock.cpp
+HEADERS += ../../src/core/rangelist.h
+SOURCES += ../../src/core/rangelist.cpp
+HEADERS += ../../src/core/rangelistbuilder.h
+SOURCES += ../../src/core/rangelistbuilder.cpp
+HEADERS += ../../src/core/chunkedrangelist.h
+SOURCES += ../../src/core/chunkedrangelist.cpp
@@ -0,0 +1,241 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+
+#include <Core/ChunkedRangeList>
+#include "../shared/utils.h"
+
+class tst_ChunkedRangeList : public QObject
+{
+    Q_OBJECT
+    void _q_common_data();
+
+private slots:
+    void test_toRangeList_data();
+    void test_toRangeList();
+
+    void test_contains();
+    void test_containers();
+    void test_strided();
+
+    void test_unite_data();
+    void test_unite();
+    void test_intersect_data();
+    void test_intersect();
+    void test_subtract_data();
+    void test_subtract();
+
+    void test_chunkedrangelist64();
+
+};
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ChunkedRangeList::_q_common_data()
+{
+    QTest::addColumn<QString>("input1");
+    QTest::addColumn<QString>("input2");
+
+    QTest::newRow("empty") << "" << "";
+    QTest::newRow("empty") << "1:10" << "";
+    QTest::newRow("sparse") << "5 17 999 65535 65536 70000" << "17 65536 100000";
+    QTest::newRow("runs") << "1:100000" << "50000:200000";
+    QTest::newRow("runs") << "65530:65540 131070:131080" << "65536:131072";
+    QTest::newRow("strided") << "1:200000:2" << "2:200000:2";
+    QTest::newRow("strided") << "1:200000:2" << "1:200000:3";
+    QTest::newRow("strided") << "5:900000:70 1000000:1200000:3" << "100:1100000:5";
+    QTest::newRow("strided") << "7:10000000:100000" << "1:500000:65537";
+    QTest::newRow("mixed") << "3 10:60000:7 70000:140000" << "1:65536:2 65537:65600 131072";
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ChunkedRangeList::test_toRangeList_data()
+{
+    this->_q_common_data();
+}
+
+void tst_ChunkedRangeList::test_toRangeList()
+{
+    // Given
+    QFETCH(QString, input1);
+    RangeListPtr expected = Tests::Utils::toRangeList(input1);
+
+    // When
+    ChunkedRangeList target(*expected);
+
+    // Then
+    QCOMPARE(target.count(), expected->count());
+    QCOMPARE(target.toRangeList().ranges(), expected->ranges());
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ChunkedRangeList::test_contains()
+{
+    ChunkedRangeList target(*Tests::Utils::toRangeList("5 10:20 100:200:10 65535:65537"));
+    QVERIFY(!target.contains(0));
+    QVERIFY(!target.contains(4));
+    QVERIFY(target.contains(5));
+    QVERIFY(target.contains(15));
+    QVERIFY(!target.contains(21));
+    QVERIFY(target.contains(150));
+    QVERIFY(!target.contains(155));
+    QVERIFY(target.contains(65535));
+    QVERIFY(target.contains(65536));
+    QVERIFY(target.contains(65537));
+    QVERIFY(!target.contains(65538));
+}
+
+void tst_ChunkedRangeList::test_containers()
+{
+    /* Runs */
+    ChunkedRangeList runs(*Tests::Utils::toRangeList("1:1000000"));
+    QCOMPARE(runs.countChunks(), 16);
+    QVERIFY(runs.memoryUsage() < 16 * 64);
+
+    /* Isolated identifiers, 2 bytes each */
+    RangeList sparse;
+    for (int i = 1; i <= 1000; ++i) {
+        sparse.add( Range(i * i) );
+    }
+    ChunkedRangeList array(sparse);
+    QCOMPARE(array.count(), 1000);
+    QVERIFY(array.memoryUsage() < 1000 * 4);
+
+    /* Bitmap, whatever the identifiers */
+    ChunkedRangeList bitmap(*Tests::Utils::toRangeList("1:65535:2"));
+    QCOMPARE(bitmap.countChunks(), 1);
+    QVERIFY(bitmap.memoryUsage() >= 8192);
+    QVERIFY(bitmap.memoryUsage() < 8192 + 256);
+}
+
+void tst_ChunkedRangeList::test_strided()
+{
+    // Given
+    RangeListPtr rangeList = Tests::Utils::toRangeList("2:20000000:2");
+
+    // When
+    ChunkedRangeList target(*rangeList);
+
+    // Then
+    QCOMPARE(target.count(), 10000000);
+    QCOMPARE(target.countChunks(), 306);
+    QVERIFY(target.contains(1999998));
+    QVERIFY(!target.contains(1999999));
+    QCOMPARE(target.toRangeList().ranges(), rangeList->ranges());
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ChunkedRangeList::test_unite_data()
+{
+    this->_q_common_data();
+}
+
+void tst_ChunkedRangeList::test_unite()
+{
+    // Given
+    QFETCH(QString, input1);
+    QFETCH(QString, input2);
+    RangeListPtr list1 = Tests::Utils::toRangeList(input1);
+    RangeListPtr list2 = Tests::Utils::toRangeList(input2);
+    ChunkedRangeList target(*list1);
+    RangeList expected = *list1;
+    expected.add(list2);
+
+    // When
+    target.unite( ChunkedRangeList(*list2) );
+
+    // Then
+    QCOMPARE(target.toRangeList().ranges(), expected.ranges());
+    QVERIFY(target == ChunkedRangeList(expected));
+}
+
+void tst_ChunkedRangeList::test_intersect_data()
+{
+    this->_q_common_data();
+}
+
+void tst_ChunkedRangeList::test_intersect()
+{
+    // Given
+    QFETCH(QString, input1);
+    QFETCH(QString, input2);
+    RangeListPtr list1 = Tests::Utils::toRangeList(input1);
+    RangeListPtr list2 = Tests::Utils::toRangeList(input2);
+    ChunkedRangeList target(*list1);
+    RangeList expected = *list1;
+    expected.intersect(list2);
+
+    // When
+    target.intersect( ChunkedRangeList(*list2) );
+
+    // Then
+    QCOMPARE(target.toRangeList().ranges(), expected.ranges());
+    QVERIFY(target == ChunkedRangeList(expected));
+}
+
+void tst_ChunkedRangeList::test_subtract_data()
+{
+    this->_q_common_data();
+}
+
+void tst_ChunkedRangeList::test_subtract()
+{
+    // Given
+    QFETCH(QString, input1);
+    QFETCH(QString, input2);
+    RangeListPtr list1 = Tests::Utils::toRangeList(input1);
+    RangeListPtr list2 = Tests::Utils::toRangeList(input2);
+    ChunkedRangeList target(*list1);
+    RangeList expected = *list1;
+    expected.remove(list2);
+
+    // When
+    target.subtract( ChunkedRangeList(*list2) );
+
+    // Then
+    QCOMPARE(target.toRangeList().ranges(), expected.ranges());
+    QVERIFY(target == ChunkedRangeList(expected));
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ChunkedRangeList::test_chunkedrangelist64()
+{
+    const qint64 offset = Q_INT64_C(7000000000000);
+    RangeList64 list;
+    list.add( Range64(offset + 1, offset + 300000) );
+    list.add( Range64(offset * 2, offset * 2 + 1000, 10) );
+
+    ChunkedRangeList64 target(list);
+    QCOMPARE(target.count(), Q_INT64_C(300101));
+    QVERIFY(target.contains(offset + 65536));
+    QVERIFY(!target.contains(offset * 2 + 5));
+    QCOMPARE(target.toRangeList().ranges(), list.ranges());
+
+    RangeList64 removed;
+    removed.add( Range64(offset + 2, offset + 300000) );
+    target.subtract( ChunkedRangeList64(removed) );
+    QCOMPARE(target.count(), Q_INT64_C(102));
+}
+
+QTEST_APPLESS_MAIN(tst_ChunkedRangeList)
+
+#include "tst_chunkedrangelist.moc"
@@ -0,0 +1,229 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include <Core/ExternalSorter>
+#include "../shared/utils.h"
+
+class tst_ExternalSorter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_collapse_data();
+    void test_collapse();
+
+    void test_collapse_output();
+    void test_collapse_output_unreadable_run();
+    void test_spill();
+    void test_buffer_capacity();
+    void test_merge_passes();
+    void test_externalsorter64();
+
+};
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ExternalSorter::test_collapse_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("empty") << "" << "";
+    QTest::newRow("single") << "12" << "12";
+    QTest::newRow("duplicates") << "5 3 5 1 3" << "1:5:2";
+    QTest::newRow("unsorted") << "9 1 7 3 5 10 11 12" << "1:9:2 10:12";
+    QTest::newRow("out_of_bounds") << "0 -4 2 -1" << "2";
+}
+
+void tst_ExternalSorter::test_collapse()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, expected);
+    ExternalSorter target;
+    foreach (auto identifier, Tests::Utils::toIntVector(input)) {
+        target.add(identifier);
+    }
+
+    // When
+    RangeList actual;
+    bool ok = target.collapse(actual);
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE(actual, *Tests::Utils::toRangeList(expected));
+    QCOMPARE(target.countRuns(), 0);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ExternalSorter::test_collapse_output()
+{
+    // Given
+    ExternalSorter target;
+    target.add(Range(10, 20, 2));
+    target.add(Range(3));
+
+    // When
+    QList<Range> actual;
+    target.collapse([&actual](const Range &range) { actual << range; });
+
+    // Then
+    QList<Range> expected;
+    expected << Range(3) << Range(10, 20, 2);
+    QCOMPARE(actual, expected);
+}
+
+void tst_ExternalSorter::test_collapse_output_unreadable_run()
+{
+    // Given
+    ExternalSorter target(256 * 1024); /* 4 runs of 32768 identifiers, merged at once */
+    QList<Range> expected;
+    for (int i = 0; i < 100000; ++i) {
+        /* Pairs of identifiers, that are never packed: 1 2 11 12 21 22... */
+        const int k = int((qint64(i) * 7919) % 100000);
+        QVERIFY(target.add(1 + 10 * (k / 2) + k % 2));
+        expected << Range(1 + 10 * (i / 2) + i % 2);
+    }
+    QVERIFY(target.countRuns() > 1);
+
+    /* Truncate a run in the middle of an identifier */
+    const QString run = target.runFileNames().first();
+    QVERIFY(QFile::resize(run, QFileInfo(run).size() / 2 + 1));
+
+    // When
+    QList<Range> actual;
+    const bool ok = target.collapse([&actual](const Range &range) { actual << range; });
+
+    // Then
+    QVERIFY(!ok);
+    QVERIFY(target.hasError());
+    QVERIFY(!actual.isEmpty());
+    QVERIFY(actual.count() < expected.count());
+    QCOMPARE(actual, expected.mid(0, actual.count()));
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ExternalSorter::test_spill()
+{
+    // Given
+    ExternalSorter target(64 * 1024); /* 8192 identifiers per run */
+    QVector<int> identifiers;
+    for (int i = 0; i < 100000; ++i) {
+        const int identifier = 1 + int((qint64(i) * 7919) % 100000) * 3;
+        identifiers << identifier << identifier;
+    }
+
+    // When
+    foreach (auto identifier, identifiers) {
+        QVERIFY(target.add(identifier));
+    }
+    QCOMPARE(target.count(), qint64(200000));
+    QVERIFY(target.countRuns() > 10);
+
+    RangeList actual;
+    QVERIFY(target.collapse(actual));
+
+    // Then
+    QVERIFY(!target.hasError());
+    QCOMPARE(target.countRuns(), 0);
+    QCOMPARE(actual.countRanges(), 1);
+    QCOMPARE(actual.ranges().first(), Range(1, 1 + 3 * 99999, 3));
+}
+
+void tst_ExternalSorter::test_buffer_capacity()
+{
+    // Given
+    ExternalSorter target(48 * 1024); /* 6144 identifiers per run */
+    const qint64 limit = target.memoryLimit() / 2; /* the radix sort takes the other half */
+
+    // When
+    for (int i = 0; i < 100000; ++i) {
+        QVERIFY(target.add(1 + int((qint64(i) * 7919) % 100000)));
+        if (target.bufferSize() > limit)
+            break;
+    }
+
+    // Then
+    QVERIFY(target.countRuns() > 10);
+    QVERIFY(target.bufferSize() > 0);
+    QVERIFY(target.bufferSize() <= limit);
+
+    // When
+    RangeList actual;
+    QVERIFY(target.collapse(actual));
+    target.setMemoryLimit(32 * 1024);
+
+    // Then
+    QCOMPARE(actual.ranges().first(), Range(1, 100000));
+    QVERIFY(target.bufferSize() > 0);
+    QVERIFY(target.bufferSize() <= target.memoryLimit() / 2);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ExternalSorter::test_merge_passes()
+{
+    /* The memory is too low to merge all the runs at once */
+    ExternalSorter target(16);
+    QVector<int> identifiers;
+    for (int i = 0; i < 200000; ++i) {
+        const int identifier = 1 + int((qint64(i) * 104729) % 300000);
+        target.add(identifier);
+        identifiers << identifier;
+    }
+    QVERIFY(target.countRuns() > 40);
+
+    RangeList expected;
+    expected.add(identifiers);
+
+    RangeList actual;
+    QVERIFY(target.collapse(actual));
+    QCOMPARE(actual, expected);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_ExternalSorter::test_externalsorter64()
+{
+    ExternalSorter64 target(64 * 1024);
+    QVector<qint64> identifiers;
+    const qint64 offset = Q_INT64_C(5000000000);
+    for (qint64 i = 0; i < 50000; ++i) {
+        const qint64 identifier = offset + (i * 7919) % 50000;
+        target.add(identifier);
+        identifiers << identifier;
+    }
+    QVERIFY(target.countRuns() > 1);
+
+    RangeList64 expected;
+    expected.add(identifiers);
+
+    RangeList64 actual;
+    QVERIFY(target.collapse(actual));
+    QCOMPARE(actual, expected);
+    QCOMPARE(actual.ranges().first(), Range64(offset, offset + 49999));
+}
+
+QTEST_APPLESS_MAIN(tst_ExternalSorter)
+
+#include "tst_externalsorter.moc"
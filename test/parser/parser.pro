@@ -6,14 +6,23 @@ SOURCES     += tst_parser.cpp
 
 # Include:
 INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
 
 # Dependancies:
 HEADERS += ../shared/utils.h
 SOURCES += ../shared/utils.cpp
 
+HEADERS += ../../src/core/decimal_p.h
 HEADERS += ../../src/core/parser.h
 SOURCES += ../../src/core/parser.cpp
 HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
 SOURCES += ../../src/core/range.cpp
+HEADERS += ../../src/core/rangeblock.h
+SOURCES += ../../src/core/rangeblock.cpp
+HEADERS += ../../src/core/rangehelper.h
+SOURCES += ../../src/core/rangehelper.cpp
 HEADERS += ../../src/core/rangelist.h
 SOURCES += ../../src/core/rangelist.cpp
+HEADERS += ../../src/core/rangelistbuilder.h
+SOURCES += ../../src/core/rangelistbuilder.cpp
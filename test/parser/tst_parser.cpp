@@ -15,10 +15,13 @@
  */
 
 #include <QtTest/QtTest>
+#include <QtCore/QBuffer>
 #include <QtCore/QDebug>
 
 #include <Core/Parser>
+#include <Core/RangeHelper>
 #include "../shared/utils.h"
+#include "../../src/core/decimal_p.h"
 
 class tst_Parser : public QObject
 {
@@ -35,10 +38,27 @@ class tst_Parser : public QObject
     void _q_femap_gui();
     void _q_hypermesh_gui();
     void _q_calc_excel_gui();
+    void _q_range_blocks();
 
 private slots:
     void test_parse();
     void test_parse_data();
+    void test_parse64();
+    void test_parse64_data();
+    void test_parse64_huge();
+    void test_parse64_huge_data();
+    void test_parse_into();
+    void test_parse_into_data();
+    void test_parse_bytes();
+    void test_parse_bytes_data();
+    void test_parse_bytes_utf8();
+    void test_parse_device();
+    void test_parse_device_data();
+    void test_parse_device_chunks();
+    void test_parse_device_chunks_data();
+    void test_parse_device_unreadable();
+    void test_parse_blocks();
+    void test_digits_vector();
 
 };
 
@@ -58,6 +78,7 @@ void tst_Parser::test_parse_data()
     this->_q_femap_gui();
     this->_q_hypermesh_gui();
     this->_q_calc_excel_gui();
+    this->_q_range_blocks();
 }
 
 void tst_Parser::test_parse()
@@ -74,6 +95,265 @@ void tst_Parser::test_parse()
     QCOMPARE( actual->ranges(), expected->ranges() );
 }
 
+void tst_Parser::test_parse_into_data()
+{
+    this->test_parse_data();
+}
+
+void tst_Parser::test_parse_into()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, rangelist);
+    RangeListPtr expected = Tests::Utils::toRangeList(rangelist);
+    RangeList actual;
+    actual.add(Range(999999));
+
+    // When
+    Parser::instance()->parse( input, actual );
+
+    // Then
+    QCOMPARE( actual.ranges(), expected->ranges() );
+}
+
+void tst_Parser::test_parse_bytes_data()
+{
+    this->test_parse_data();
+}
+
+void tst_Parser::test_parse_bytes()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, rangelist);
+    RangeListPtr expected = Tests::Utils::toRangeList(rangelist);
+    const QByteArray bytes = input.toUtf8();
+
+    // When
+    RangeListPtr actual = Parser::instance()->parse( bytes );
+    RangeList64 actual64;
+    actual64.add(Range64(999999));
+    Parser::instance()->parse64( bytes.constData(), bytes.size(), actual64 );
+
+    // Then
+    QCOMPARE( actual->ranges(), expected->ranges() );
+    QCOMPARE( actual64.count(), qint64(actual->count()) );
+}
+
+void tst_Parser::test_parse_bytes_utf8()
+{
+    // Given
+    const QString input = QString::fromUtf8("N\xC5\x93ud 15:20 caf\xC3\xA9 30 \xC3\xA930 40");
+    RangeListPtr expected = Tests::Utils::toRangeList("15:20 30 40");
+
+    // When
+    RangeListPtr fromUtf8 = Parser::instance()->parse( input.toUtf8() );
+    RangeListPtr fromLatin1 = Parser::instance()->parse( input.toLatin1() );
+    RangeListPtr fromString = Parser::instance()->parse( input );
+
+    // Then
+    QCOMPARE( fromUtf8->ranges(), expected->ranges() );
+    QCOMPARE( fromLatin1->ranges(), expected->ranges() );
+    QCOMPARE( fromString->ranges(), expected->ranges() );
+}
+
+void tst_Parser::test_parse_device_data()
+{
+    this->test_parse_data();
+}
+
+void tst_Parser::test_parse_device()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, rangelist);
+    RangeListPtr expected = Tests::Utils::toRangeList(rangelist);
+    QByteArray bytes = input.toUtf8();
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+    RangeList actual;
+    actual.add(Range(999999));
+
+    // When
+    const bool ok = Parser::instance()->parse( &buffer, actual );
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE( actual.ranges(), expected->ranges() );
+}
+
+void tst_Parser::test_parse_device_chunks_data()
+{
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("rangelist");
+
+    /* The device is read by chunks of 64 KB */
+    const QString text("\"Node 681\" // @\n\"350 THRU 681\" // @\n\"500 1 2 3");
+    for (int offset = -40; offset <= 8; ++offset) {
+        QTest::newRow(qPrintable(QString("offset %1").arg(offset)))
+                << 65536 + offset << text << "1:3 681350:681500";
+    }
+    QTest::newRow("long segment") << 65530 << QString("1%1 2").arg(QString(70000, '0')) << "2";
+}
+
+void tst_Parser::test_parse_device_chunks()
+{
+    // Given
+    QFETCH(int, offset);
+    QFETCH(QString, input);
+    QFETCH(QString, rangelist);
+    RangeListPtr expected = Tests::Utils::toRangeList(rangelist);
+    QByteArray bytes = QByteArray(offset, ' ') + input.toLatin1();
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+    RangeList actual;
+
+    // When
+    const bool ok = Parser::instance()->parse( &buffer, actual );
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE( actual.ranges(), expected->ranges() );
+}
+
+void tst_Parser::test_parse_device_unreadable()
+{
+    // Given
+    QBuffer buffer;
+    RangeList actual;
+    actual.add(Range(10));
+
+    // When
+    const bool ok = Parser::instance()->parse( &buffer, actual );
+
+    // Then
+    QVERIFY(!ok);
+    QCOMPARE( actual.count(), 1 );
+}
+
+void tst_Parser::test_parse_blocks()
+{
+    // Given
+    RangeList expected;
+    expected.add(RangeBlock(Range(95004122, 95004123), 10, 3));
+    expected.add(RangeBlock(Range(1, 5, 2), 100, 4));
+    expected.add(Range(500, 600));
+    QStringList blocks;
+    foreach (const RangeBlock &block, expected.blocks()) {
+        blocks << RangeHelper::instance()->toPackedString(block);
+    }
+    const QString text = blocks.join(' ');
+
+    // When
+    RangeListPtr actual = Parser::instance()->parse(text);
+
+    // Then
+    QVERIFY(text.contains('['));
+    QCOMPARE( actual->ranges(), expected.ranges() );
+}
+
+void tst_Parser::test_digits_vector()
+{
+    /* The vector kernels give the same counts and values as the scalar loops,
+     * for any count of digits, of readable characters, and any next character */
+    const QList<QByteArray> digits = QList<QByteArray>()
+            << "9876543210123456" << "0000000000000001" << "9999999999999999" << "1234567890123456";
+    const QList<QChar> nexts = QList<QChar>()
+            << QChar(' ') << QChar('/') << QChar(':') << QChar(0x0130) << QChar(0x0660);
+
+    foreach (const QByteArray &run, digits) {
+        foreach (const QChar &next, nexts) {
+            for (int count = 0; count <= C_MAX_DIGITS_PER_STEP; ++count) {
+                for (int available = count; available <= count + 20; ++available) {
+                    // Given
+                    QString text = QString::fromLatin1(run.left(count));
+                    text += QString(available - count, next);
+                    const QByteArray bytes = text.toLatin1();
+                    const ushort *chars = text.utf16();
+                    const int max = qMin(available, C_MAX_DIGITS_PER_STEP);
+
+                    // When
+                    const int actualCount = _q_digitCount(chars, max);
+                    const int actualBytesCount = _q_digitCount(bytes.constData(), max);
+                    const quint64 actualValue = _q_digitsValue(chars, count, available);
+                    const quint64 actualBytesValue = _q_digitsValue(bytes.constData(), count, available);
+
+                    // Then
+                    QCOMPARE(actualCount, _q_digitCountScalar(chars, max));
+                    QCOMPARE(actualBytesCount, _q_digitCountScalar(
+                                 reinterpret_cast<const uchar *>(bytes.constData()), max));
+                    QCOMPARE(actualValue, _q_digitsValueScalar(chars, count));
+                    QCOMPARE(actualBytesValue, _q_digitsValueScalar(bytes.constData(), count));
+                }
+            }
+        }
+    }
+
+#if !defined(__SSE4_1__)
+    QSKIP("The SSE4.1 and AVX2 kernels are not compiled, build with CONFIG+=simd");
+#endif
+}
+
+void tst_Parser::test_parse64_data()
+{
+    this->test_parse_data();
+}
+
+void tst_Parser::test_parse64()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, rangelist);
+    RangeList64Ptr expected = Tests::Utils::toRangeList64(rangelist);
+
+    // When
+    RangeList64Ptr actual = Parser::instance()->parse64( input );
+
+    // Then
+    QCOMPARE( actual->ranges(), expected->ranges() );
+}
+
+void tst_Parser::test_parse64_huge_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("rangelist");
+
+    QTest::newRow("32-bit limit") << "2147483647" << "2147483647";
+    QTest::newRow("32-bit limit") << "2147483648" << "2147483648";
+    QTest::newRow("32-bit limit") << "2147483646:2147483650" << "2147483646:2147483650";
+
+    QTest::newRow("offset numbering") << "1000000000001 1000000000002 1000000000003"
+                                      << "1000000000001:1000000000003";
+    QTest::newRow("offset numbering") << "20000000000:90000000000:10000000000"
+                                      << "20000000000:90000000000:10000000000";
+    QTest::newRow("offset numbering") << "GRID 3000000000001 THRU 3000000000100 BY 33"
+                                      << "3000000000001:3000000000100:33";
+
+    QTest::newRow("long digit runs") << "1234567890123456 12345678901234567"
+                                     << "1234567890123456 12345678901234567";
+    QTest::newRow("long digit runs") << "000000000000000000001:0000000000000000000000000003"
+                                     << "1:3";
+
+    QTest::newRow("too large") << "4611686018427387904" << "";
+    QTest::newRow("too large") << "9223372036854775808" << "";
+    QTest::newRow("too large") << "15:99999999999999999999" << "15";
+}
+
+void tst_Parser::test_parse64_huge()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, rangelist);
+    RangeList64Ptr expected = Tests::Utils::toRangeList64(rangelist);
+
+    // When
+    RangeList64Ptr actual = Parser::instance()->parse64( input );
+
+    // Then
+    QCOMPARE( actual->ranges(), expected->ranges() );
+}
+
 /*************************************************************************
  *************************************************************************/
 void tst_Parser::_q_trivial()
@@ -173,6 +453,10 @@ void tst_Parser::_q_nastran_bulk_file()
     QTest::newRow("nastran")<< "5THRU9" << "";
     QTest::newRow("nastran")<< "41THRU50BY3" << "";
     QTest::newRow("nastran")<< "41THRU50STEP3" << "";
+    QTest::newRow("nastran")<< "5 THRUS 9" << "5 9";
+    QTest::newRow("nastran incomplete")<< "5 THRU" << "";
+    QTest::newRow("nastran incomplete")<< "41 THRU 50 BY" << "41:50";
+    QTest::newRow("nastran incomplete")<< "41 THRU 50 BY 3 THRU" << "41:50:3";
 
     /* SET xx = */
     QTest::newRow("nastran")<< "1 THRU 100000" << "1:100000";
@@ -333,6 +617,10 @@ void tst_Parser::_q_patran_session_group_file()
                "682090:682230:10 682410:682430:10 "
                "691350:691420:10 " ;
 
+    QTest::newRow("patran ses file with keyword cuts")
+            << "\"5 TH\" // @\n"
+               "\"RU 9\" )\n"
+            << "5:9" ;
 
 }
 
@@ -424,6 +712,23 @@ void tst_Parser::_q_calc_excel_gui()
 
 }
 
+void tst_Parser::_q_range_blocks()
+{
+    QTest::newRow("block") << "[122:123]:142:10" << "122 123 132 133 142 143";
+    QTest::newRow("block") << "[5]:25:10" << "5:25:10";
+    QTest::newRow("block") << "[1:5:2]:101:100" << "1:5:2 101:105:2";
+    QTest::newRow("block") << "7 THRU 9 [1:2]:21:10 30" << "1 2 7:9 11 12 21 22 30";
+    QTest::newRow("block") << "\"[1:2]:\" // @\n\"21:10\"" << "1 2 11 12 21 22";
+
+    QTest::newRow("bad block") << "[1:2]:22:10" << "";
+    QTest::newRow("bad block") << "[1:20]:21:10" << "";
+    QTest::newRow("bad block") << "[1:2]" << "";
+    QTest::newRow("bad block") << "[1:2]:21" << "";
+    QTest::newRow("bad block") << "[]:1:1" << "";
+    QTest::newRow("bad block") << "[1:2]:21:0" << "";
+    QTest::newRow("bad block") << "[3:1]:23:10" << "";
+}
+
 QTEST_APPLESS_MAIN(tst_Parser)
 
 #include "tst_parser.moc"
@@ -6,7 +6,9 @@ SOURCES     += tst_range.cpp
 
 # Include:
 INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
 
 # Dependancies:
 HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
 SOURCES += ../../src/core/range.cpp
@@ -34,6 +34,18 @@ private slots:
     /* Booleans */
     void test_equals();
 
+    /* Set Operations */
+    void test_contains();
+    void test_intersected_data();
+    void test_intersected();
+    void test_subtracted();
+    void test_united();
+
+    /* 64-bit identifiers */
+    void test_range64_count();
+    void test_range64_maximum();
+    void test_range64_set_operations();
+
 };
 
 /*************************************************************************
@@ -177,6 +189,146 @@ void tst_Range::test_equals()
 
 }
 
+/*************************************************************************
+ *************************************************************************/
+void tst_Range::test_contains()
+{
+    Range target(2, 10, 4); // == [2 6 10]
+    QCOMPARE( target.contains(2), true );
+    QCOMPARE( target.contains(6), true );
+    QCOMPARE( target.contains(10), true );
+    QCOMPARE( target.contains(4), false );
+    QCOMPARE( target.contains(14), false );
+    QCOMPARE( Range().contains(0), false );
+}
+
+void tst_Range::test_intersected_data()
+{
+    QTest::addColumn<int>("from1");
+    QTest::addColumn<int>("to1");
+    QTest::addColumn<int>("by1");
+    QTest::addColumn<int>("from2");
+    QTest::addColumn<int>("to2");
+    QTest::addColumn<int>("by2");
+    QTest::addColumn<int>("expected_from");
+    QTest::addColumn<int>("expected_to");
+    QTest::addColumn<int>("expected_by");
+
+    QTest::newRow("empty")       << 0  << 0   << 0 << 1  << 10  << 1 << 0  << 0  << 1;
+    QTest::newRow("disjoint")    << 1  << 10  << 1 << 20 << 30  << 1 << 0  << 0  << 1;
+    QTest::newRow("overlapping") << 1  << 20  << 1 << 15 << 30  << 1 << 15 << 20 << 1;
+    QTest::newRow("contained")   << 1  << 100 << 1 << 20 << 40  << 5 << 20 << 40 << 5;
+    QTest::newRow("odd even")    << 1  << 99  << 2 << 2  << 100 << 2 << 0  << 0  << 1;
+    QTest::newRow("phases")      << 1  << 100 << 4 << 3  << 100 << 6 << 9  << 93 << 12;
+    QTest::newRow("coprime")     << 1  << 100 << 3 << 2  << 100 << 5 << 7  << 97 << 15;
+    QTest::newRow("single")      << 1  << 100 << 7 << 50 << 0   << 0 << 50 << 50 << 1;
+    QTest::newRow("patran")      << 31276989 << 31277019 << 10
+                                 << 31280111 << 31280129 << 6
+                                 << 0 << 0 << 1;
+}
+
+void tst_Range::test_intersected()
+{
+    // Given
+    QFETCH(int, from1);
+    QFETCH(int, to1);
+    QFETCH(int, by1);
+    QFETCH(int, from2);
+    QFETCH(int, to2);
+    QFETCH(int, by2);
+    QFETCH(int, expected_from);
+    QFETCH(int, expected_to);
+    QFETCH(int, expected_by);
+    Range r1(from1, to1, by1);
+    Range r2(from2, to2, by2);
+    Range expected(expected_from, expected_to, expected_by);
+
+    // When
+    Range actual1 = r1.intersected(r2);
+    Range actual2 = r2.intersected(r1);
+
+    // Then
+    QCOMPARE( actual1, expected );
+    QCOMPARE( actual2, expected );
+}
+
+void tst_Range::test_subtracted()
+{
+    QList<Range> expected;
+    expected << Range(1, 4) << Range(6, 9) << Range(11, 14) << Range(16, 20);
+    QCOMPARE( Range(1, 20, 1).subtracted( Range(5, 15, 5) ), expected );
+
+    expected.clear();
+    expected << Range(1, 19, 2);
+    QCOMPARE( Range(1, 20, 1).subtracted( Range(2, 20, 2) ), expected );
+
+    expected.clear();
+    expected << Range(10, 25, 5) << Range(35);
+    QCOMPARE( Range(10, 40, 5).subtracted( Range(30, 70, 2) ), expected );
+
+    expected.clear();
+    QCOMPARE( Range(20, 40, 10).subtracted( Range(1, 100, 1) ), expected );
+}
+
+void tst_Range::test_united()
+{
+    QList<Range> expected;
+    expected << Range(1, 100);
+    QCOMPARE( Range(1, 99, 2).united( Range(2, 100, 2) ), expected );
+
+    expected.clear();
+    expected << Range(1, 5) << Range(20, 30, 5);
+    QCOMPARE( Range(20, 30, 5).united( Range(1, 5, 1) ), expected );
+
+    expected.clear();
+    expected << Range(10, 30, 5) << Range(32) << Range(34, 36) << Range(38, 70, 2);
+    QCOMPARE( Range(10, 40, 5).united( Range(30, 70, 2) ), expected );
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_Range::test_range64_count()
+{
+    QCOMPARE( Range(1, 2147483647).count(), 2147483647 );
+    QCOMPARE( Range64(1, Q_INT64_C(2147483647)).count(), Q_INT64_C(2147483647) );
+    QCOMPARE( Range64(1, Q_INT64_C(10000000000)).count(), Q_INT64_C(10000000000) );
+    QCOMPARE( Range64(Q_INT64_C(20000000000), Q_INT64_C(90000000000), Q_INT64_C(10000000000)).count(),
+              Q_INT64_C(8) );
+}
+
+void tst_Range::test_range64_maximum()
+{
+    const qint64 max = Range64::maximum();
+    QCOMPARE( Range64(max).count(), Q_INT64_C(1) );
+    QVERIFY( Range64(max + 1).isEmpty() );
+    QVERIFY( Range64(1, max + 1).isEmpty() );
+    QVERIFY( !Range64(1, max).isEmpty() );
+}
+
+void tst_Range::test_range64_set_operations()
+{
+    const qint64 offset = Q_INT64_C(1000000000000);
+
+    QVERIFY( Range64(offset + 1, offset + 99, 2).contains(offset + 51) );
+    QVERIFY( !Range64(offset + 1, offset + 99, 2).contains(offset + 50) );
+
+    QCOMPARE( Range64(offset + 1, offset + 100, 4).intersected( Range64(offset + 3, offset + 100, 6) ),
+              Range64(offset + 9, offset + 93, 12) );
+
+    /* The LCM of the steps is greater than any identifier */
+    const qint64 step = Q_INT64_C(0x2000000000000000);
+    QCOMPARE( Range64(1, Range64::maximum(), step).intersected( Range64(1, Range64::maximum(), step - 1) ),
+              Range64(1) );
+
+    QList<Range64> expected;
+    expected << Range64(offset + 1, offset + 19, 2);
+    QCOMPARE( Range64(offset + 1, offset + 20).subtracted( Range64(offset + 2, offset + 20, 2) ), expected );
+
+    expected.clear();
+    expected << Range64(offset + 1, offset + 100);
+    QCOMPARE( Range64(offset + 1, offset + 99, 2).united( Range64(offset + 2, offset + 100, 2) ), expected );
+}
+
 
 QTEST_APPLESS_MAIN(tst_Range)
 
@@ -0,0 +1,16 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_rangeblock
+CONFIG      += testcase
+QT           = core testlib
+SOURCES     += tst_rangeblock.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
+
+# Dependancies:
+HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
+SOURCES += ../../src/core/range.cpp
+HEADERS += ../../src/core/rangeblock.h
+SOURCES += ../../src/core/rangeblock.cpp
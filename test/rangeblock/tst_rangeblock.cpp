@@ -0,0 +1,144 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+
+#include <Core/RangeBlock>
+
+Q_DECLARE_METATYPE(Range)
+
+class tst_RangeBlock : public QObject
+{
+    Q_OBJECT
+private slots:
+    void test_count_data();
+    void test_count();
+    void test_isEmpty();
+
+    /* Getters */
+    void test_getters();
+    void test_runs();
+
+    /* Set Operations */
+    void test_contains();
+
+    /* 64-bit identifiers */
+    void test_rangeblock64();
+
+};
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeBlock::test_count_data()
+{
+    QTest::addColumn<Range>("run");
+    QTest::addColumn<int>("period");
+    QTest::addColumn<int>("repeat");
+    QTest::addColumn<int>("expected");
+
+    QTest::newRow("empty") << Range() << 10 << 3 << 0;
+    QTest::newRow("no repeat") << Range(5, 7) << 10 << 0 << 0;
+    QTest::newRow("single run") << Range(5, 7) << 0 << 1 << 3;
+    QTest::newRow("pairs") << Range(122, 123) << 10 << 3 << 6;
+    QTest::newRow("strided runs") << Range(1, 9, 2) << 100 << 4 << 20;
+    QTest::newRow("adjacent runs") << Range(1, 10) << 10 << 3 << 30;
+    QTest::newRow("overlapping runs") << Range(1, 10) << 9 << 3 << 0;
+    QTest::newRow("out of bounds") << Range(2147483000, 2147483001) << 100 << 10 << 0;
+}
+
+void tst_RangeBlock::test_count()
+{
+    QFETCH(Range, run);
+    QFETCH(int, period);
+    QFETCH(int, repeat);
+    QFETCH(int, expected);
+    RangeBlock block(run, period, repeat);
+    QCOMPARE(block.count(), expected);
+}
+
+void tst_RangeBlock::test_isEmpty()
+{
+    QVERIFY(RangeBlock().isEmpty());
+    QVERIFY(RangeBlock(Range(1, 10), 5, 2).isEmpty());
+    QVERIFY(!RangeBlock(Range(1, 10), 11, 2).isEmpty());
+
+    RangeBlock block(Range(1, 2), 10, 3);
+    block.clear();
+    QVERIFY(block.isEmpty());
+    QCOMPARE(block.count(), 0);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeBlock::test_getters()
+{
+    RangeBlock block(Range(122, 123), 10, 3);
+    QCOMPARE(block.run(), Range(122, 123));
+    QCOMPARE(block.period(), 10);
+    QCOMPARE(block.repeat(), 3);
+    QCOMPARE(block.from(), 122);
+    QCOMPARE(block.to(), 143);
+    QCOMPARE(block.runAt(1), Range(132, 133));
+    QVERIFY(block.runAt(3).isEmpty());
+
+    /* The period of a single run is meaningless */
+    QCOMPARE(RangeBlock(Range(5, 7), 10, 1), RangeBlock(Range(5, 7)));
+}
+
+void tst_RangeBlock::test_runs()
+{
+    RangeBlock block(Range(1, 9, 4), 100, 3);
+    QList<Range> expected;
+    expected << Range(1, 9, 4) << Range(101, 109, 4) << Range(201, 209, 4);
+    QCOMPARE(block.runs(), expected);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeBlock::test_contains()
+{
+    RangeBlock block(Range(122, 123), 10, 3);
+    QVERIFY(!block.contains(121));
+    QVERIFY(block.contains(122));
+    QVERIFY(block.contains(123));
+    QVERIFY(!block.contains(124));
+    QVERIFY(!block.contains(131));
+    QVERIFY(block.contains(132));
+    QVERIFY(block.contains(143));
+    QVERIFY(!block.contains(152));
+
+    RangeBlock strided(Range(1, 9, 4), 100, 2);
+    QVERIFY(strided.contains(105));
+    QVERIFY(!strided.contains(106));
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeBlock::test_rangeblock64()
+{
+    const qint64 offset = Q_INT64_C(5000000000);
+    RangeBlock64 block(Range64(offset + 2, offset + 3), 10, 1000000);
+    QCOMPARE(block.count(), Q_INT64_C(2000000));
+    QCOMPARE(block.to(), offset + 3 + Q_INT64_C(9999990));
+    QVERIFY(block.contains(offset + 12));
+    QVERIFY(!block.contains(offset + 14));
+    QVERIFY(RangeBlock64(Range64(Range64::maximum() - 20, Range64::maximum() - 19), 10, 4).isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_RangeBlock)
+
+#include "tst_rangeblock.moc"
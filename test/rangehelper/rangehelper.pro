@@ -6,9 +6,13 @@ SOURCES     += tst_rangehelper.cpp
 
 # Include:
 INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
 
 # Dependancies:
 HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
 SOURCES += ../../src/core/range.cpp
+HEADERS += ../../src/core/rangeblock.h
+SOURCES += ../../src/core/rangeblock.cpp
 HEADERS += ../../src/core/rangehelper.h
 SOURCES += ../../src/core/rangehelper.cpp
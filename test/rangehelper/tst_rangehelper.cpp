@@ -29,6 +29,10 @@ private slots:
     void test_toUnpackedStringList_data();
     void test_toUnpackedStringList();
 
+    void test_range64();
+    void test_unpack_32bit_limit();
+    void test_block();
+
 };
 
 /*************************************************************************
@@ -103,7 +107,51 @@ void tst_RangeHelper::test_toUnpackedStringList()
     QCOMPARE( actual, list );
 }
 
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeHelper::test_range64()
+{
+    RangeHelper *rh = RangeHelper::instance();
+    const qint64 offset = Q_INT64_C(5000000000);
+
+    QCOMPARE( rh->toPackedString( Range64(offset) ), QString("5000000000") );
+    QCOMPARE( rh->toPackedString( Range64(offset, offset + 5) ), QString("5000000000:5000000005") );
+    QCOMPARE( rh->toPackedString( Range64(offset, offset * 3, offset) ),
+              QString("5000000000:15000000000:5000000000") );
+
+    QStringList expected;
+    expected << "5000000000" << "10000000000" << "15000000000";
+    QCOMPARE( rh->toUnpackedStringList( Range64(offset, offset * 3, offset) ), expected );
+}
+
+void tst_RangeHelper::test_unpack_32bit_limit()
+{
+    RangeHelper *rh = RangeHelper::instance();
+    QStringList expected;
+    expected << "2147483646" << "2147483647";
+    QCOMPARE( rh->toUnpackedStringList( Range(2147483646, 2147483647) ), expected );
+}
+
+
 
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeHelper::test_block()
+{
+    RangeHelper *rh = RangeHelper::instance();
+
+    RangeBlock block(Range(95004122, 95004123), 10, 3);
+    QCOMPARE(rh->toPackedString(block), QString("[95004122:95004123]:95004142:10"));
+    QStringList expected;
+    expected << "95004122" << "95004123" << "95004132" << "95004133" << "95004142" << "95004143";
+    QCOMPARE(rh->toUnpackedStringList(block), expected);
+
+    QCOMPARE(rh->toPackedString(RangeBlock(Range(3, 9, 3))), QString("3:9:3"));
+    QCOMPARE(rh->toPackedString(RangeBlock()), QString());
+
+    RangeBlock64 block64(Range64(Q_INT64_C(5000000001), Q_INT64_C(5000000009), 4), 100, 2);
+    QCOMPARE(rh->toPackedString(block64), QString("[5000000001:5000000009:4]:5000000101:100"));
+}
 
 QTEST_APPLESS_MAIN(tst_RangeHelper)
 
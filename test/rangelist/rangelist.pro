@@ -6,12 +6,18 @@ SOURCES     += tst_rangelist.cpp
 
 # Include:
 INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
 
 # Dependancies:
 HEADERS += ../shared/utils.h
 SOURCES += ../shared/utils.cpp
 
 HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
 SOURCES += ../../src/core/range.cpp
+HEADERS += ../../src/core/rangeblock.h
+SOURCES += ../../src/core/rangeblock.cpp
 HEADERS += ../../src/core/rangelist.h
 SOURCES += ../../src/core/rangelist.cpp
+HEADERS += ../../src/core/rangelistbuilder.h
+SOURCES += ../../src/core/rangelistbuilder.cpp
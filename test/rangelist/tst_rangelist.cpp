@@ -20,6 +20,8 @@
 #include <Core/RangeList>
 #include "../shared/utils.h"
 
+Q_DECLARE_METATYPE(Range)
+
 class tst_RangeList : public QObject
 {
     Q_OBJECT
@@ -31,6 +33,12 @@ private slots:
     void test_expand_data();
     void test_collapse();
     void test_collapse_data();
+    void test_collapseUnsorted();
+    void test_collapseUnsorted_data();
+    void test_collapseProgressions();
+    void test_collapseProgressions_data();
+    void test_unite();
+    void test_unite_data();
 
     /* Black Box Tests */
     void test_clear();
@@ -44,12 +52,40 @@ private slots:
     void test_add_duplicated();
     void test_add_overlapping();
     void test_add_big_ranges();
+    void test_add_interleaved();
+    void test_add_huge_ranges();
+    void test_add_small_data();
+    void test_add_small();
+    void test_add_many();
+    void test_add_many_big();
+    void test_add_identifiers_big();
+    void test_dense();
 
     void test_remove_empty();
     void test_remove_simple();
     void test_remove();
     void test_remove_big();
     void test_remove_big_fragmented();
+    void test_remove_one_from_huge();
+    void test_remove_strided();
+
+    void test_intersect();
+    void test_intersect_strided();
+    void test_symmetricDifference();
+    void test_complement();
+    void test_optimalRanges();
+    void test_blocks();
+    void test_add_remove_block();
+    void test_view();
+    void test_add_rvalue();
+    void test_implicit_sharing();
+
+    void test_contains();
+    void test_rank();
+    void test_select();
+    void test_countInInterval();
+
+    void test_rangelist64();
 
     void test_equals();
     void test_equals_2();
@@ -57,6 +93,7 @@ private slots:
 };
 
 class FriendlyRangeList : public RangeList { friend class tst_RangeList; };
+class FriendlyRangeList64 : public RangeList64 { friend class tst_RangeList; };
 
 /*************************************************************************
  *************************************************************************/
@@ -155,6 +192,136 @@ void tst_RangeList::test_collapse()
     QCOMPARE(actual, expected->ranges());
 }
 
+void tst_RangeList::test_collapseUnsorted_data()
+{
+    this->test_collapse_data();
+
+    QTest::newRow("out_of_bounds") << "0 -5 3 -1 2 1" << "1:3";
+    QTest::newRow("bytes") << "65536 256 1 16777216" << "1 256 65536 16777216";
+    QTest::newRow("int_max") << "2147483647 2147483646 2147483645" << "2147483645:2147483647";
+}
+
+void tst_RangeList::test_collapseUnsorted()
+{
+    // Given
+    QFETCH(QString, input_int);
+    QFETCH(QString, expected_ranges);
+    QVector<int> input = Tests::Utils::toIntVector(input_int);
+    RangeListPtr expected = Tests::Utils::toRangeList(expected_ranges);
+
+    // When
+    RangeArray actual = FriendlyRangeList::_q_collapseUnsorted(input);
+
+    // Then
+    QCOMPARE(actual, expected->canonicalRanges());
+}
+
+void tst_RangeList::test_collapseProgressions_data()
+{
+    QTest::addColumn<int>("singles");
+    QTest::addColumn<int>("length1");
+    QTest::addColumn<int>("by1");
+    QTest::addColumn<int>("length2");
+    QTest::addColumn<int>("by2");
+
+    /* The steps are compared by blocks of 8, 4 or 2 identifiers: the progressions
+     * start after a few singles, and end or change of stride on each side of the
+     * block boundaries, or at the tail. */
+    const int lengths[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 16, 17, 24, 25 };
+    for (int singles = 0; singles < 4; ++singles) {
+        foreach (const int length1, lengths) {
+            const QString name = QString("%0 singles, %1 values").arg(singles).arg(length1);
+            QTest::newRow(qPrintable(name + " at tail")) << singles << length1 << 3 << 0 << 0;
+            QTest::newRow(qPrintable(name + " then stride change")) << singles << length1 << 1 << 9 << 7;
+            QTest::newRow(qPrintable(name + " then 2 values")) << singles << length1 << 5 << 2 << 1;
+            QTest::newRow(qPrintable(name + " then 1 value")) << singles << length1 << 2 << 1 << 100;
+        }
+    }
+}
+
+void tst_RangeList::test_collapseProgressions()
+{
+    // Given
+    QFETCH(int, singles);
+    QFETCH(int, length1);
+    QFETCH(int, by1);
+    QFETCH(int, length2);
+    QFETCH(int, by2);
+    QVector<int> input;
+    QList<Range> expected;
+    for (int i = 0; i < singles; ++i) {
+        input << (1 << i); // 1 2 4 8: no 3 values equally spaced
+        expected << Range(1 << i);
+    }
+    for (int i = 0; i < length1; ++i) {
+        input << 1000 + i * by1;
+    }
+    const int last = input.last();
+    expected << Range(1000, last, by1);
+    for (int i = 1; i <= length2; ++i) {
+        input << last + i * by2;
+        if (length2 < 3)
+            expected << Range(last + i * by2);
+    }
+    if (length2 >= 3)
+        expected << Range(last + by2, last + length2 * by2, by2);
+
+    const qint64 offset = Q_INT64_C(3000000000000);
+    QVector<qint64> input64;
+    foreach (auto identifier, input) {
+        input64 << offset + identifier;
+    }
+    QList<Range64> expected64;
+    foreach (auto range, expected) {
+        expected64 << Range64(offset + range.from(), offset + range.to(), range.by());
+    }
+
+    // When
+    RangeArray actual = FriendlyRangeList::_q_collapseUnsorted(input);
+    RangeArray64 actual64 = FriendlyRangeList64::_q_collapseUnsorted(input64);
+
+    // Then
+    QCOMPARE(actual.toList(), expected);
+    QCOMPARE(actual64.toList(), expected64);
+}
+
+void tst_RangeList::test_unite_data()
+{
+    QTest::addColumn<QList<Range> >("input");
+    QTest::addColumn<QString>("expected_ranges");
+
+    QTest::newRow("empty") << QList<Range>() << "";
+    QTest::newRow("single") << (QList<Range>() << Range(5)) << "5";
+    QTest::newRow("disjoint") << (QList<Range>() << Range(1, 3) << Range(10, 20, 5)) << "1:3 10:20:5";
+    QTest::newRow("adjacent") << (QList<Range>() << Range(1, 3) << Range(4, 6)) << "1:6";
+    QTest::newRow("contained") << (QList<Range>() << Range(1, 100) << Range(20, 40, 3)) << "1:100";
+    QTest::newRow("duplicate") << (QList<Range>() << Range(20, 22) << Range(20, 22)) << "20:22";
+    QTest::newRow("odd even") << (QList<Range>() << Range(1, 99, 2) << Range(2, 100, 2)) << "1:100";
+    QTest::newRow("interleaved") << (QList<Range>() << Range(1, 13, 3) << Range(2, 14, 3))
+                                 << "1 2 4 5 7 8 10 11 13 14";
+    QTest::newRow("overlapping") << (QList<Range>() << Range(10, 40, 5) << Range(30, 70, 2))
+                                 << "10:30:5 32 34:36 38:70:2";
+}
+
+void tst_RangeList::test_unite()
+{
+    // Given
+    QFETCH(QList<Range>, input);
+    QFETCH(QString, expected_ranges);
+    RangeListPtr expected = Tests::Utils::toRangeList(expected_ranges);
+
+    RangeArray ranges;
+    foreach (auto range, input) {
+        ranges.append(range);
+    }
+
+    // When
+    RangeArray actual = FriendlyRangeList::_q_unite(ranges);
+
+    // Then
+    QCOMPARE(actual, expected->canonicalRanges());
+}
+
 /*************************************************************************
  *************************************************************************/
 void tst_RangeList::test_clear()
@@ -306,6 +473,188 @@ void tst_RangeList::test_add_big_ranges()
     QCOMPARE(actual, expected);
 }
 
+void tst_RangeList::test_add_interleaved()
+{
+    RangeList target;
+    target.add( Range(1, 999999, 2) );  // odd identifiers
+    target.add( Range(2, 1000000, 2) ); // even identifiers
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1, 1000000, 1);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_add_huge_ranges()
+{
+    RangeList target;
+    target.add( Range(1, 100000000, 1) );
+    target.add( Range(50000000, 150000000, 1) );
+    target.add( Range(200000000, 290000000, 10) );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1, 150000000, 1);
+    expected << Range(200000000, 290000000, 10);
+    QCOMPARE(actual, expected);
+    QCOMPARE(target.count(), 159000001);
+}
+
+void tst_RangeList::test_add_small_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("added");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("inside") << "1:10" << "5" << "1:10";
+    QTest::newRow("before") << "10:20" << "1" << "1 10:20";
+    QTest::newRow("after") << "1:10" << "12" << "1:10 12";
+    QTest::newRow("bridge") << "1:10 20:30" << "11:19" << "1:30";
+    QTest::newRow("extends previous") << "1:3 10" << "4" << "1:4 10";
+    QTest::newRow("packs previous singles") << "1 2 20" << "3" << "1:3 20";
+    QTest::newRow("packs previous singles") << "2 4 9 11 13" << "6" << "2:6:2 9:13:2";
+    QTest::newRow("repacks next") << "10 12:14" << "8" << "8:12:2 13 14";
+    QTest::newRow("repacks next") << "10 12:14 16:18" << "8" << "8:12:2 13 14 16:18";
+    QTest::newRow("repacks next") << "10 12:14 20:30:5" << "8" << "8:12:2 13 14 20:30:5";
+    QTest::newRow("several") << "1:10 50:60" << "20 30 40" << "1:10 20:50:10 51:60";
+    QTest::newRow("several") << "5 7 9:15:3 16 20:40:10" << "6 8 18" << "5:9 12 15 16:20:2 30 40";
+}
+
+void tst_RangeList::test_add_small()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, added);
+    QFETCH(QString, expected);
+    RangeList target;
+    target.add( Tests::Utils::toRangeList(input) );
+    const RangeList snapshot = target;
+
+    // When
+    target.add( Tests::Utils::toRangeList(added)->ranges() );
+
+    // Then
+    QCOMPARE( target.ranges(), Tests::Utils::toRangeList(expected)->ranges() );
+    QCOMPARE( snapshot.ranges(), Tests::Utils::toRangeList(input)->ranges() );
+}
+
+void tst_RangeList::test_add_many()
+{
+    // Given
+    QList<RangeListPtr> others;
+    others << Tests::Utils::toRangeList("1:999999:2");   // odd identifiers
+    others << Tests::Utils::toRangeList("2:1000000:2");  // even identifiers
+    others << RangeListPtr(new RangeList());
+    others << Tests::Utils::toRangeList("5 1000001 2000000:2000010");
+    RangeList target;
+    target.add( Range(3000000) );
+
+    // When
+    target.add( others );
+
+    // Then
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1, 1000001, 1);
+    expected << Range(2000000, 2000010, 1);
+    expected << Range(3000000);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_add_many_big()
+{
+    // Given
+    QList<RangeListPtr> others;
+    for (int i = 0; i < 200; ++i) {
+        QList<Range> ranges;
+        for (int j = 0; j < 500; ++j) {
+            ranges << Range(1 + i + 200 * j * j);
+        }
+        RangeListPtr other(new RangeList());
+        other->add( ranges );
+        others << other;
+    }
+    RangeList expected;
+    foreach (auto other, others) {
+        expected.add( other );
+    }
+
+    // When
+    RangeList actual;
+    actual.add( others );
+
+    // Then
+    QCOMPARE(actual.ranges(), expected.ranges());
+    QCOMPARE(actual.countRanges(), 499);
+    QCOMPARE(actual.count(), 100000);
+}
+
+void tst_RangeList::test_add_identifiers_big()
+{
+    // Given
+    const int count = 3000000;
+    QVector<int> identifiers;
+    identifiers.reserve(2 * count);
+    for (int i = 0; i < count; ++i) {
+        const int scrambled = int((qint64(i) * 7919) % count);
+        identifiers << 1 + 3 * scrambled;
+        identifiers << 1 + 3 * (count - 1 - scrambled);  // duplicates
+    }
+    identifiers << 0 << -5;
+
+    // When
+    RangeList target;
+    target.add( identifiers );
+
+    // Then
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1, 1 + 3 * (count - 1), 3);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_dense()
+{
+    /* Renumbered part: the identifiers fill a short window */
+    const int from = 30950001;
+    const int to = 30959999;
+
+    // Given
+    QVector<int> identifiers;
+    for (int i = to; i >= from; --i) {
+        if (i % 7 != 0)
+            identifiers << i;
+    }
+    QVector<int> multiplesOf3;
+    for (int i = from; i <= to; ++i) {
+        if (i % 3 == 0)
+            multiplesOf3 << i;
+    }
+
+    // When
+    RangeList target;
+    target.add( identifiers );
+    RangeList other;
+    other.add( multiplesOf3 );
+
+    RangeList difference = target;
+    difference.remove( other );
+    RangeList intersection = target;
+    intersection.intersect( RangeListPtr(new RangeList(other)) );
+    RangeList symmetricDifference = target;
+    symmetricDifference.symmetricDifference( RangeListPtr(new RangeList(other)) );
+
+    // Then
+    QCOMPARE(target.count(), identifiers.count());
+    QCOMPARE(other.countRanges(), 1);
+    for (int i = from - 1; i <= to + 1; ++i) {
+        const bool inTarget = (i >= from && i <= to && i % 7 != 0);
+        const bool inOther = (i >= from && i <= to && i % 3 == 0);
+        QCOMPARE(target.contains(i), inTarget);
+        QCOMPARE(difference.contains(i), inTarget && !inOther);
+        QCOMPARE(intersection.contains(i), inTarget && inOther);
+        QCOMPARE(symmetricDifference.contains(i), inTarget != inOther);
+    }
+}
+
 /*************************************************************************
  *************************************************************************/
 void tst_RangeList::test_remove_empty()
@@ -364,6 +713,322 @@ void tst_RangeList::test_remove_big_fragmented()
     QCOMPARE( target.count(), 114286 );    // ((142,858 - 3) * 4/5 ) + 2 == 114,286 entries
 }
 
+void tst_RangeList::test_remove_one_from_huge()
+{
+    RangeList target;
+    target.add( Range(1, 50000000, 1) );
+    target.remove( Range(25000000) );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1, 24999999, 1);
+    expected << Range(25000001, 50000000, 1);
+    QCOMPARE(actual, expected);
+    QCOMPARE( target.count(), 49999999 );
+}
+
+void tst_RangeList::test_remove_strided()
+{
+    /* INPUT                                              */
+    /* 10-15-20-...-25---30------35-----40                */
+    /*                   30-32-34-36-38-40-42-...-68-70   */
+    /*                                                    */
+    /* ExPECTED                                           */
+    /* 10-15-20-25----------35                            */
+    RangeList target;
+    target.add( Range(10, 40, 5) );
+    target.remove( Range(30, 70, 2) );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(10, 25, 5);
+    expected << Range(35, 35, 1);
+    QCOMPARE(actual, expected);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeList::test_intersect()
+{
+    RangeList target;
+    target.add( Range(1, 20, 1) );
+    target.add( Range(30, 40, 2) );
+    target.intersect( Tests::Utils::toRangeList("15:35:5") );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(15) << Range(20) << Range(30);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_intersect_strided()
+{
+    RangeList target;
+    target.add( Range(1, 10000000, 4) );
+    target.intersect( Tests::Utils::toRangeList("3:10000000:6") );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(9, 9999993, 12);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_symmetricDifference()
+{
+    RangeList target;
+    target.add( Range(1, 100, 1) );
+    target.symmetricDifference( Tests::Utils::toRangeList("51:150") );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1, 50) << Range(101, 150);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_complement()
+{
+    RangeList target;
+    target.add( Range(3, 5) );
+    target.add( Range(8) );
+    target.complement( Range(1, 10) );
+    QList<Range> actual = target.ranges();
+    QList<Range> expected;
+    expected << Range(1) << Range(2) << Range(6) << Range(7) << Range(9) << Range(10);
+    QCOMPARE(actual, expected);
+}
+
+void tst_RangeList::test_blocks()
+{
+    RangeList target;
+    target.add( *Tests::Utils::toRangeList("95004112 95004122 95004123 95004132 95004133 95004142 95004143") );
+    target.add( *Tests::Utils::toRangeList("100000000:100000003 100000010:100000013 100000020:100000023") );
+    target.add( *Tests::Utils::toRangeList("200000000:200000009") );
+
+    QList<RangeBlock> actual = target.blocks();
+    QList<RangeBlock> expected;
+    expected << RangeBlock(Range(95004112));
+    expected << RangeBlock(Range(95004122, 95004123), 10, 3);
+    expected << RangeBlock(Range(100000000, 100000003), 10, 3);
+    expected << RangeBlock(Range(200000000, 200000009));
+    QCOMPARE(actual, expected);
+
+    /* The blocks hold the same identifiers */
+    RangeList blocks;
+    foreach (auto block, actual) {
+        blocks.add( block );
+    }
+    QCOMPARE(blocks, target);
+}
+
+void tst_RangeList::test_add_remove_block()
+{
+    RangeList target;
+    target.add( RangeBlock(Range(122, 123), 10, 3) );
+    QCOMPARE(target.count(), 6);
+    QCOMPARE(target.ranges(), Tests::Utils::toRangeList("122 123 132 133 142 143")->ranges());
+
+    target.add( Range(120, 150) );
+    target.remove( RangeBlock(Range(124, 131), 10, 2) );
+    QCOMPARE(target.ranges(), Tests::Utils::toRangeList("120:123 132:133 142:150")->ranges());
+}
+
+void tst_RangeList::test_view()
+{
+    // Given
+    RangeList target;
+    target.add( *Tests::Utils::toRangeList("1:10 15 20:30:2 40:50") );
+    RangeList other;
+    other.add( *Tests::Utils::toRangeList("5:12 20:40") );
+
+    // When
+    RangeSpan view = target.view();
+
+    // Then
+    QCOMPARE(view.count(), 4);
+    QCOMPARE(view.first(), Range(1, 10));
+    QCOMPARE(view.at(2), Range(20, 30, 2));
+    QCOMPARE(view.last(), Range(40, 50));
+
+    QList<Range> walked;
+    for (const Range &range : view) {
+        walked << range;
+    }
+    QCOMPARE(walked, target.ranges());
+
+    /* Add and remove a part of another list, without copying it */
+    RangeList added;
+    added.add( other.view().mid(1, 1) );
+    QCOMPARE(added.ranges(), Tests::Utils::toRangeList("20:40")->ranges());
+
+    target.remove( other.view() );
+    QCOMPARE(target.ranges(), Tests::Utils::toRangeList("1:4 15 41:50")->ranges());
+}
+
+void tst_RangeList::test_add_rvalue()
+{
+    // Given
+    RangeList target;
+    RangeList temporary;
+    temporary.add( Range(1, 100, 3) );
+
+    // When
+    target.add( std::move(temporary) );
+
+    // Then
+    QCOMPARE(target.count(), 34);
+    QCOMPARE(target.countInInterval(1, 50), 17);
+    QCOMPARE(temporary.count(), 0);
+
+    // When
+    RangeList other;
+    other.add( Range(2, 5) );
+    target.add( std::move(other) );
+
+    // Then
+    QCOMPARE(target.ranges(), Tests::Utils::toRangeList("1:5 7:100:3")->ranges());
+    QCOMPARE(other.countRanges(), 0);
+}
+
+void tst_RangeList::test_implicit_sharing()
+{
+    // Given
+    RangeList target;
+    target.add( *Tests::Utils::toRangeList("1:10 20:30:2") );
+
+    // When
+    const RangeList snapshot = target;
+    target.add( Range(11, 15) );
+    target.remove( Range(24) );
+
+    // Then
+    QCOMPARE(snapshot.ranges(), Tests::Utils::toRangeList("1:10 20:30:2")->ranges());
+    QCOMPARE(snapshot.countInInterval(1, 30), 16);
+    QCOMPARE(target.ranges(), Tests::Utils::toRangeList("1:15 20:22:2 26:30:2")->ranges());
+
+    // When
+    RangeList copy = snapshot;
+    copy.clear();
+
+    // Then
+    QCOMPARE(copy.count(), 0);
+    QCOMPARE(snapshot.count(), 16);
+    QVERIFY(copy != snapshot);
+}
+
+void tst_RangeList::test_optimalRanges()
+{
+    RangeList target;
+    target.add( *Tests::Utils::toRangeList("10:20:5 21 22") );
+
+    // Greedy packing is kept when it's optimal
+    QList<Range> expected;
+    expected << Range(10, 20, 5) << Range(21) << Range(22);
+    QCOMPARE(target.optimalRanges(PackingCost::rangeCount()), expected);
+
+    // "10 15 20:22" is shorter than "10:20:5 21 22"
+    expected.clear();
+    expected << Range(10) << Range(15) << Range(20, 22);
+    QCOMPARE(target.optimalRanges(PackingCost::patranText()), expected);
+
+    // Long ranges are cut near their ends only
+    target.clear();
+    target.add( Range(1, 3) );
+    target.add( Range(5, 2000000000, 2) );
+    expected.clear();
+    expected << Range(1) << Range(2) << Range(3, 2000000000 - 1, 2);
+    QCOMPARE(target.ranges().count(), 2);
+    QCOMPARE(target.optimalRanges(PackingCost::nastranFields()), expected);
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+void tst_RangeList::test_contains()
+{
+    RangeList target;
+    target.add( Range(10, 14) );
+    target.add( Range(20, 30, 5) );
+    QVERIFY(!target.contains(9));
+    QVERIFY(target.contains(10));
+    QVERIFY(target.contains(14));
+    QVERIFY(!target.contains(15));
+    QVERIFY(target.contains(20));
+    QVERIFY(!target.contains(21));
+    QVERIFY(target.contains(25));
+    QVERIFY(target.contains(30));
+    QVERIFY(!target.contains(35));
+}
+
+void tst_RangeList::test_rank()
+{
+    RangeList target;
+    target.add( Range(10, 14) );
+    target.add( Range(20, 30, 5) );
+    QCOMPARE(target.rank(-5), 0);
+    QCOMPARE(target.rank(10), 0);
+    QCOMPARE(target.rank(12), 2);
+    QCOMPARE(target.rank(17), 5);
+    QCOMPARE(target.rank(20), 5);
+    QCOMPARE(target.rank(21), 6);
+    QCOMPARE(target.rank(25), 6);
+    QCOMPARE(target.rank(30), 7);
+    QCOMPARE(target.rank(99), 8);
+}
+
+void tst_RangeList::test_select()
+{
+    RangeList target;
+    target.add( Range(10, 14) );
+    target.add( Range(20, 30, 5) );
+    QCOMPARE(target.select(0), 10);
+    QCOMPARE(target.select(2), 12);
+    QCOMPARE(target.select(4), 14);
+    QCOMPARE(target.select(5), 20);
+    QCOMPARE(target.select(6), 25);
+    QCOMPARE(target.select(7), 30);
+    QCOMPARE(target.select(8), 0);
+    QCOMPARE(target.select(-1), 0);
+
+    for (int i = 0; i < target.count(); ++i) {
+        QCOMPARE(target.rank(target.select(i)), i);
+    }
+}
+
+void tst_RangeList::test_countInInterval()
+{
+    RangeList target;
+    target.add( Range(10, 14) );
+    target.add( Range(20, 30, 5) );
+    QCOMPARE(target.countInInterval(0, 100), 8);
+    QCOMPARE(target.countInInterval(12, 22), 4);
+    QCOMPARE(target.countInInterval(15, 19), 0);
+    QCOMPARE(target.countInInterval(25, 25), 1);
+    QCOMPARE(target.countInInterval(30, 10), 0);
+
+    target.clear();
+    QCOMPARE(target.countInInterval(0, 100), 0);
+}
+
+/***********************************************************************************
+ ***********************************************************************************/
+void tst_RangeList::test_rangelist64()
+{
+    const qint64 offset = Q_INT64_C(3000000000000);
+
+    RangeList64 target;
+    target.add( Range64(1, Q_INT64_C(4000000000)) );
+    target.add( Range64(offset + 10, offset + 30, 10) );
+    target.remove( Range64(offset + 20) );
+    QCOMPARE(target.count(), Q_INT64_C(4000000002));
+    QCOMPARE(target.countRanges(), 3);
+
+    QVERIFY(target.contains(Q_INT64_C(3999999999)));
+    QVERIFY(target.contains(offset + 30));
+    QVERIFY(!target.contains(offset + 20));
+    QCOMPARE(target.rank(offset + 30), Q_INT64_C(4000000001));
+    QCOMPARE(target.select(Q_INT64_C(4000000000)), offset + 10);
+    QCOMPARE(target.countInInterval(Q_INT64_C(2000000001), offset + 15), Q_INT64_C(2000000001));
+
+    RangeList64 other;
+    other.add( Range64(offset + 10) );
+    other.add( Range64(offset + 30) );
+    other.add( Range64(1, Q_INT64_C(4000000000)) );
+    QVERIFY(target == other);
+}
 
 /*************************************************************************
  *************************************************************************/
@@ -0,0 +1,144 @@
+/* - Range ID Convertor - Copyright (C) 2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+
+#include <Core/RangeListBuilder>
+#include "../shared/utils.h"
+
+class tst_RangeListBuilder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_finish_data();
+    void test_finish();
+
+    void test_finish_into_non_empty();
+    void test_finish_many();
+    void test_rangelistbuilder64();
+
+};
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeListBuilder::test_finish_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("empty") << "" << "";
+    QTest::newRow("single") << "5" << "5";
+    QTest::newRow("unsorted") << "9 1:4 5 8 7 6" << "1:9";
+    QTest::newRow("duplicates") << "3 3 1:5:2 5" << "1:5:2";
+    QTest::newRow("overlapping") << "1:10 5:20 30:40:2 32" << "1:20 30:40:2";
+}
+
+void tst_RangeListBuilder::test_finish()
+{
+    // Given
+    QFETCH(QString, input);
+    QFETCH(QString, expected);
+    RangeListBuilder target;
+    foreach (auto item, input.split(' ', QString::SkipEmptyParts)) {
+        QStringList bounds = item.split(':');
+        if (bounds.count() == 1) {
+            target.add( bounds.at(0).toInt() );
+        } else {
+            const int by = (bounds.count() > 2) ? bounds.at(2).toInt() : 1;
+            target.add( Range(bounds.at(0).toInt(), bounds.at(1).toInt(), by) );
+        }
+    }
+
+    // When
+    RangeList actual;
+    target.finish( actual );
+
+    // Then
+    QCOMPARE(actual, *Tests::Utils::toRangeList(expected));
+    QVERIFY(target.isEmpty());
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeListBuilder::test_finish_into_non_empty()
+{
+    // Given
+    RangeList actual;
+    actual.add( Range(1, 10) );
+    RangeListBuilder target;
+    target.add( 11 );
+    target.add( 12 );
+    target.add( 0 ); // ignored
+    target.add( RangeBlock(Range(20, 21), 10, 2) );
+
+    // When
+    target.finish( actual );
+
+    // Then
+    QList<Range> expected;
+    expected << Range(1, 12) << Range(20) << Range(21) << Range(30) << Range(31);
+    QCOMPARE(actual.ranges(), expected);
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeListBuilder::test_finish_many()
+{
+    /* Tokens of a Patran session file, unpacked and packed */
+    const int count = 100000;
+
+    // Given
+    RangeListBuilder target;
+    target.reserve(count, count);
+    for (int i = count - 1; i >= 0; --i) {
+        target.add( 1 + 10 * i );
+        target.add( Range(2 + 10 * i, 4 + 10 * i) );
+    }
+
+    // When
+    RangeList actual;
+    target.finish( actual );
+
+    // Then
+    QCOMPARE(actual.count(), 4 * count);
+    QCOMPARE(actual.countRanges(), count);
+    QCOMPARE(actual.ranges().first(), Range(1, 4));
+    QCOMPARE(actual.ranges().last(), Range(1 + 10 * (count - 1), 4 + 10 * (count - 1)));
+}
+
+/*************************************************************************
+ *************************************************************************/
+void tst_RangeListBuilder::test_rangelistbuilder64()
+{
+    const qint64 offset = Q_INT64_C(5000000000);
+
+    RangeListBuilder64 target;
+    target.add( offset + 3 );
+    target.add( Range64(offset, offset + 2) );
+
+    RangeList64 actual;
+    target.finish( actual );
+
+    QList<Range64> expected;
+    expected << Range64(offset, offset + 3);
+    QCOMPARE(actual.ranges(), expected);
+}
+
+QTEST_APPLESS_MAIN(tst_RangeListBuilder)
+
+#include "tst_rangelistbuilder.moc"
@@ -6,6 +6,7 @@ SOURCES     += tst_utils.cpp
 
 # Include:
 INCLUDEPATH += ../../include
+include(../../src/core/simd.pri)
 
 # Dependancies:
 HEADERS += utils.h
@@ -14,6 +15,11 @@ SOURCES += utils.cpp
 HEADERS += ../../src/core/parser.h
 SOURCES += ../../src/core/parser.cpp
 HEADERS += ../../src/core/range.h
+HEADERS += ../../src/core/range_p.h
 SOURCES += ../../src/core/range.cpp
+HEADERS += ../../src/core/rangeblock.h
+SOURCES += ../../src/core/rangeblock.cpp
 HEADERS += ../../src/core/rangelist.h
 SOURCES += ../../src/core/rangelist.cpp
+HEADERS += ../../src/core/rangelistbuilder.h
+SOURCES += ../../src/core/rangelistbuilder.cpp
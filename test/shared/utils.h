@@ -19,11 +19,13 @@
 
 #include <Core/Range>
 #include <Core/RangeList>
+#include <Core/RangeListBuilder>
 
 #include <QtCore/QList>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QSet>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 #include <QtCore/QDebug>
 
 namespace Tests {
@@ -40,9 +42,10 @@ namespace Utils {
     return ranges;
 }*/
 
-static inline RangeListPtr toRangeList(const QString &str)
+template <typename T>
+static inline QSharedPointer<BasicRangeList<T> > toBasicRangeList(const QString &str)
 {
-    QList<Range> ranges;
+    QList<BasicRange<T> > ranges;
     QRegularExpression rx("^(?<from>\\d+)(:(?<to>\\d+)(:(?<by>[+-]?\\d+))?)?$");
 
     QStringList items = str.split(' ', QString::SkipEmptyParts);
@@ -52,16 +55,18 @@ static inline RangeListPtr toRangeList(const QString &str)
         Q_ASSERT(match.hasMatch() && "String input must match formats """
                                      "'from', 'from:to', or 'from:to:by'.");
         if (match.hasMatch()) {
-            int from = match.captured("from").toInt();
-            int to = match.captured("to").toInt();
-            int by = match.captured("by").toInt();
-            ranges.append( Range(from, to, by) );
+            T from = T(match.captured("from").toLongLong());
+            T to = T(match.captured("to").toLongLong());
+            T by = T(match.captured("by").toLongLong());
+            ranges.append( BasicRange<T>(from, to, by) );
         }
     }
-    RangeListPtr res(new RangeList);
+    QSharedPointer<BasicRangeList<T> > res(new BasicRangeList<T>);
+    BasicRangeListBuilder<T> builder;
     foreach (auto range, ranges) {
-        res->add( Range(range) );
+        builder.add( range );
     }
+    builder.finish( *res );
     if (res->countRanges() != ranges.count()) {
         QString msg = QString("\n\n\n"
                               "*** FATAL ERROR DETECTED!\n"
@@ -74,6 +79,16 @@ static inline RangeListPtr toRangeList(const QString &str)
     return res;
 }
 
+static inline RangeListPtr toRangeList(const QString &str)
+{
+    return toBasicRangeList<Identifier>(str);
+}
+
+static inline RangeList64Ptr toRangeList64(const QString &str)
+{
+    return toBasicRangeList<Identifier64>(str);
+}
+
 static inline QSet<int> toIntSet(const QString &str)
 {
     QSet<int> res;
@@ -87,6 +102,19 @@ static inline QSet<int> toIntSet(const QString &str)
     return res;
 }
 
+static inline QVector<int> toIntVector(const QString &str)
+{
+    QVector<int> res;
+    QStringList list = str.split(' ', QString::SkipEmptyParts);
+    foreach (const QString item, list) {
+        bool ok;
+        int value = item.toInt(&ok);
+        Q_ASSERT(ok && "this is not an integer");
+        res.append( value );
+    }
+    return res;
+}
+
 } // end namespace Utils
 
 } // end namespace Tests
@@ -1,9 +1,13 @@
 TEMPLATE = subdirs
 CONFIG  += ordered
 
+SUBDIRS += $$PWD/chunkedrangelist
+SUBDIRS += $$PWD/externalsorter
 SUBDIRS += $$PWD/parser
 SUBDIRS += $$PWD/range
+SUBDIRS += $$PWD/rangeblock
 SUBDIRS += $$PWD/rangehelper
 SUBDIRS += $$PWD/rangelist
+SUBDIRS += $$PWD/rangelistbuilder
 SUBDIRS += $$PWD/shared
 